@@ -0,0 +1,211 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+
+#include "gametheme.h"
+#include "benchmark.h"
+
+std::string Bench::Result::toString(void) const
+{
+    std::ostringstream os;
+
+    os << std::left << std::setw(40) << name << " " <<
+	std::right << std::setw(12) << std::fixed << std::setprecision(1) << nsMedian << " ns/op" << ", " <<
+	"min: " << nsMin << ", " << "max: " << nsMax << ", " << "iterations: " << iterations;
+
+    return os.str();
+}
+
+JsonObject Bench::Result::toJsonObject(void) const
+{
+    JsonObject jo;
+
+    jo.addString("name", name);
+    jo.addInteger("iterations", iterations);
+    jo.addDouble("ns_per_op", nsMedian);
+    jo.addDouble("ns_min", nsMin);
+    jo.addDouble("ns_max", nsMax);
+
+    return jo;
+}
+
+Bench::Runner::Runner(const std::string & name, int argc, char** argv)
+    : Application(argv[0], false, Size(0, 0), "default"), suite(name), repeats(5), mintime(200), randseed(BENCH_SEED_DEFAULT)
+{
+    LogWrapper::init(domain(), argv[0]);
+
+#ifdef RUNEWARS_THEME
+    theme = RUNEWARS_THEME;
+#endif
+    if(Systems::environment("RUNEWARS_THEME"))
+	theme = Systems::environment("RUNEWARS_THEME");
+
+    parseCommandOptions(argc, argv);
+}
+
+void Bench::Runner::parseCommandOptions(int argc, char** argv)
+{
+    int opt;
+
+    while((opt = Systems::GetCommandOptions(argc, argv, "hf:o:r:m:s:t:")) != -1)
+    switch(opt)
+    {
+	case 'f':
+	    if(Systems::GetOptionsArgument())
+		filter = Systems::GetOptionsArgument();
+	    break;
+
+	case 'o':
+	    if(Systems::GetOptionsArgument())
+		output = Systems::GetOptionsArgument();
+	    break;
+
+	case 'r':
+	    if(Systems::GetOptionsArgument())
+		repeats = std::max(1, String::toInt(Systems::GetOptionsArgument()));
+	    break;
+
+	case 'm':
+	    if(Systems::GetOptionsArgument())
+		mintime = std::max(1, String::toInt(Systems::GetOptionsArgument()));
+	    break;
+
+	case 's':
+	    if(Systems::GetOptionsArgument())
+		randseed = String::toInt(Systems::GetOptionsArgument());
+	    break;
+
+	case 't':
+	    if(Systems::GetOptionsArgument())
+		theme = Systems::GetOptionsArgument();
+	    break;
+
+	case '?':
+	case 'h':
+	    COUT("Usage: " << argv[0] << " [OPTIONS]\n" <<
+		"\t-f\trun only benchmarks with name contains string\n" <<
+		"\t-o\tsave json results to file (stdout is default)\n" <<
+		"\t-r\trepeats count (5 is default)\n" <<
+		"\t-m\tminimal time for repeat, ms (200 is default)\n" <<
+		"\t-s\trandom seed for input data\n" <<
+		"\t-t\ttheme name\n" <<
+		"\t-h\tprint this help and exit\n");
+	    exit(0);
+
+	default:  break;
+    }
+}
+
+bool Bench::Runner::initGameData(void)
+{
+    return GameTheme::initHeadless(*this);
+}
+
+Bench::Runner & Bench::Runner::add(const std::string & name, const Function & func)
+{
+    cases.emplace_back(name, func);
+    return *this;
+}
+
+Bench::Result Bench::Runner::measure(const Case & cs) const
+{
+    Result res;
+    res.name = cs.name;
+
+    // calibrate: iterations for one repeat >= mintime
+    const double limit = mintime * 1000000.0;
+    size_t count = 1;
+
+    while(true)
+    {
+	auto tp = std::chrono::steady_clock::now();
+	cs.func(count);
+	double ns = elapsedNs(tp);
+
+	if(ns >= limit || count >= (static_cast<size_t>(1) << 40))
+	    break;
+
+	count = ns < limit / 100 ? count * 10 :
+		    std::max(count + 1, static_cast<size_t>(count * limit * 1.1 / ns));
+    }
+
+    std::vector<double> times;
+    times.reserve(repeats);
+
+    for(int it = 0; it < repeats; ++it)
+    {
+	auto tp = std::chrono::steady_clock::now();
+	cs.func(count);
+	times.push_back(elapsedNs(tp) / count);
+    }
+
+    std::sort(times.begin(), times.end());
+
+    res.iterations = count;
+    res.nsMedian = times[times.size() / 2];
+    res.nsMin = times.front();
+    res.nsMax = times.back();
+
+    return res;
+}
+
+int Bench::Runner::exec(void)
+{
+    JsonArray ja;
+
+    for(auto & cs : cases)
+    {
+	if(filter.size() && std::string::npos == cs.name.find(filter))
+	    continue;
+
+	Result res = measure(cs);
+	std::cerr << res.toString() << std::endl;
+	ja.addObject(res.toJsonObject());
+    }
+
+    JsonObject jo;
+    jo.addString("suite", suite);
+    jo.addString("version", version());
+    jo.addString("theme", theme);
+    jo.addInteger("seed", randseed);
+    jo.addInteger("repeats", repeats);
+    jo.addInteger("mintime_ms", mintime);
+    jo.addArray("benchmarks", ja);
+
+    if(output.empty())
+    {
+	std::cout << jo.toString() << std::endl;
+    }
+    else
+    if(! Systems::saveString2File(jo.toString(), output))
+    {
+	ERROR("save results error: " << output);
+	return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef _RWNA_BENCHMARK_
+#define _RWNA_BENCHMARK_
+
+#include <list>
+#include <string>
+#include <chrono>
+#include <functional>
+
+#include "runewars.h"
+
+#define BENCH_SEED_DEFAULT	20201010
+
+namespace Bench
+{
+    /* body: run the measured code N times */
+    typedef std::function<void(size_t)> Function;
+
+    struct Result
+    {
+	std::string		name;
+	size_t			iterations;
+	double			nsMedian;
+	double			nsMin;
+	double			nsMax;
+
+	Result() : iterations(0), nsMedian(0), nsMin(0), nsMax(0) {}
+
+	std::string		toString(void) const;
+	JsonObject		toJsonObject(void) const;
+    };
+
+    struct Case
+    {
+	std::string		name;
+	Function		func;
+
+	Case(const std::string & str, const Function & fn) : name(str), func(fn) {}
+    };
+
+    class Runner : public Application
+    {
+	std::string		suite;
+	std::list<Case>		cases;
+	std::string		filter;
+	std::string		output;
+	int			repeats;
+	int			mintime; // ms
+	unsigned int		randseed;
+
+	void			parseCommandOptions(int argc, char** argv);
+	Result			measure(const Case &) const;
+
+    public:
+	Runner(const std::string &, int argc, char** argv);
+
+	unsigned int		seed(void) const { return randseed; }
+	bool			initGameData(void);
+
+	Runner &		add(const std::string &, const Function &);
+	int			exec(void);
+    };
+
+    template<typename T>
+    inline void doNotOptimize(const T & val)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(val) : "memory");
+#else
+	static volatile const void* sink; sink = & val;
+#endif
+    }
+
+    inline double elapsedNs(const std::chrono::steady_clock::time_point & tp)
+    {
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - tp).count();
+    }
+}
+
+#endif
@@ -0,0 +1,371 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <new>
+#include <vector>
+#include <cstdlib>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <algorithm>
+
+#include <sys/resource.h>
+
+#include "gametheme.h"
+#include "threadpool.h"
+#include "simulation.h"
+#include "benchmark.h"
+
+/* allocation counters: all game code, per worker thread */
+namespace
+{
+    thread_local uint64_t allocCount = 0;
+    thread_local uint64_t allocBytes = 0;
+}
+
+void* operator new(std::size_t sz)
+{
+    allocCount += 1;
+    allocBytes += sz;
+
+    if(void* ptr = std::malloc(sz ? sz : 1))
+	return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t sz)
+{
+    return ::operator new(sz);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+    const int phasesCount = Menu::GameLoadPart + 1;
+
+    const char* phaseName(int menu)
+    {
+	switch(menu)
+	{
+	    case Menu::MahjongInitPart:		return "MahjongInitPart";
+	    case Menu::MahjongPart:		return "MahjongPart";
+	    case Menu::MahjongSummaryPart:	return "MahjongSummaryPart";
+	    case Menu::AdventurePart:		return "AdventurePart";
+	    case Menu::BattleSummaryPart:	return "BattleSummaryPart";
+	    default: break;
+	}
+
+	return nullptr;
+    }
+
+    /* plain data: summary of worker games */
+    struct GameStats
+    {
+	uint64_t		games = 0;
+	uint64_t		failed = 0;
+	uint64_t		phaseNs[phasesCount] = { 0 };
+	uint64_t		mahjongSteps = 0;
+	uint64_t		adventureSteps = 0;
+	uint64_t		actions = 0;
+	uint64_t		battles = 0;
+	uint64_t		allocs = 0;
+	uint64_t		allocBytes = 0;
+
+	GameStats & operator+= (const GameStats & st)
+	{
+	    games += st.games;
+	    failed += st.failed;
+	    for(int it = 0; it < phasesCount; ++it)
+		phaseNs[it] += st.phaseNs[it];
+	    mahjongSteps += st.mahjongSteps;
+	    adventureSteps += st.adventureSteps;
+	    actions += st.actions;
+	    battles += st.battles;
+	    allocs += st.allocs;
+	    allocBytes += st.allocBytes;
+	    return *this;
+	}
+    };
+
+    GameStats playGames(const std::vector<unsigned int> & seeds)
+    {
+	GameStats res;
+
+	for(auto & seed : seeds)
+	{
+	    const uint64_t allocs = allocCount;
+	    const uint64_t bytes = allocBytes;
+
+	    Simulation::initGame(seed);
+	    int menu = Menu::MahjongInitPart;
+
+	    while(menu != Menu::GameExit && menu != Menu::GameSummaryPart)
+	    {
+		Simulation::PartStats stats;
+
+		auto tp = std::chrono::steady_clock::now();
+		int next = Simulation::playPart(menu, & stats);
+		uint64_t ns = Bench::elapsedNs(tp);
+
+		// battles resolved on adventure part, see the battle summary
+		if(menu == Menu::AdventurePart)
+		{
+		    uint64_t battlesNs = std::min(ns, static_cast<uint64_t>(stats.battlesTime.count()));
+		    res.phaseNs[Menu::BattleSummaryPart] += battlesNs;
+		    ns -= battlesNs;
+		    res.adventureSteps += stats.steps;
+		}
+		else
+		if(menu == Menu::MahjongPart)
+		    res.mahjongSteps += stats.steps;
+
+		res.phaseNs[menu] += ns;
+		res.actions += stats.actions;
+		res.battles += stats.battles;
+
+		menu = next;
+	    }
+
+	    if(menu == Menu::GameSummaryPart)
+		res.games++;
+	    else
+		res.failed++;
+
+	    res.allocs += allocCount - allocs;
+	    res.allocBytes += allocBytes - bytes;
+	}
+
+	return res;
+    }
+
+    long peakRssKb(int who)
+    {
+	struct rusage usage;
+	return 0 == getrusage(who, & usage) ? usage.ru_maxrss : 0;
+    }
+}
+
+class GameBench : public Application
+{
+    std::string			output;
+    int				games;
+    int				jobs;
+    unsigned int		randseed;
+
+    void			parseCommandOptions(int argc, char** argv);
+    bool			runWorkers(const std::vector<std::vector<unsigned int>> &, GameStats &) const;
+
+public:
+    GameBench(int argc, char** argv);
+
+    int				exec(void);
+};
+
+GameBench::GameBench(int argc, char** argv) : Application(argv[0], false, Size(0, 0), "default"),
+    games(10), jobs(1), randseed(BENCH_SEED_DEFAULT)
+{
+    LogWrapper::init(domain(), argv[0]);
+
+#ifdef RUNEWARS_THEME
+    theme = RUNEWARS_THEME;
+#endif
+    if(Systems::environment("RUNEWARS_THEME"))
+	theme = Systems::environment("RUNEWARS_THEME");
+
+    parseCommandOptions(argc, argv);
+}
+
+void GameBench::parseCommandOptions(int argc, char** argv)
+{
+    int opt;
+
+    while((opt = Systems::GetCommandOptions(argc, argv, "hn:j:o:s:t:")) != -1)
+    switch(opt)
+    {
+	case 'n':
+	    if(Systems::GetOptionsArgument())
+		games = std::max(1, String::toInt(Systems::GetOptionsArgument()));
+	    break;
+
+	case 'j':
+	    if(Systems::GetOptionsArgument())
+		jobs = std::max(0, String::toInt(Systems::GetOptionsArgument()));
+	    break;
+
+	case 'o':
+	    if(Systems::GetOptionsArgument())
+		output = Systems::GetOptionsArgument();
+	    break;
+
+	case 's':
+	    if(Systems::GetOptionsArgument())
+		randseed = String::toInt(Systems::GetOptionsArgument());
+	    break;
+
+	case 't':
+	    if(Systems::GetOptionsArgument())
+		theme = Systems::GetOptionsArgument();
+	    break;
+
+	case '?':
+	case 'h':
+	    COUT("Usage: " << argv[0] << " [OPTIONS]\n" <<
+		"\t-n\tgames count (10 is default)\n" <<
+		"\t-j\tworker threads, 0: thread per core (1 is default)\n" <<
+		"\t-o\tsave json results to file (stdout is default)\n" <<
+		"\t-s\tfirst random seed, game N uses seed + N\n" <<
+		"\t-t\ttheme name\n" <<
+		"\t-h\tprint this help and exit\n");
+	    exit(0);
+
+	default:  break;
+    }
+}
+
+bool GameBench::runWorkers(const std::vector<std::vector<unsigned int>> & seeds, GameStats & res) const
+{
+    // game session per worker thread, catalogs shared
+    std::vector<GameStats> stats(seeds.size());
+    ThreadPool pool(seeds.size());
+
+    for(size_t it = 0; it < seeds.size(); ++it)
+    {
+	pool.push([&seeds, &stats, it]()
+	{
+	    Simulation::SessionScope scope;
+	    stats[it] = playGames(seeds[it]);
+	});
+    }
+
+    pool.wait();
+
+    for(auto & st : stats)
+	res += st;
+
+    return true;
+}
+
+int GameBench::exec(void)
+{
+    if(! GameTheme::initHeadless(*this))
+	return EXIT_FAILURE;
+
+    const int workers = jobs ? jobs : std::max(1U, std::thread::hardware_concurrency());
+    std::vector<std::vector<unsigned int>> seeds(std::min(workers, games));
+
+    for(int it = 0; it < games; ++it)
+	seeds[it % seeds.size()].push_back(randseed + it);
+
+    GameStats stats;
+    auto tp = std::chrono::steady_clock::now();
+
+    if(1 == jobs)
+	stats = playGames(seeds.front());
+    else
+    if(! runWorkers(seeds, stats))
+	return EXIT_FAILURE;
+
+    const double wallNs = Bench::elapsedNs(tp);
+    const double played = std::max(static_cast<uint64_t>(1), stats.games + stats.failed);
+
+    JsonObject phases;
+    for(int it = 0; it < phasesCount; ++it)
+    {
+	if(const char* name = phaseName(it))
+	{
+	    phases.addDouble(name, stats.phaseNs[it] / played / 1000000.0);
+	    std::cerr << name << ": " << stats.phaseNs[it] / played / 1000000.0 << " ms/game" << std::endl;
+	}
+    }
+
+    JsonObject jo;
+    jo.addString("suite", "game");
+    jo.addString("version", version());
+    jo.addString("theme", theme);
+    jo.addString("mode", 1 == jobs ? "single" : "threads");
+    jo.addInteger("workers", seeds.size());
+    jo.addInteger("seed", randseed);
+    jo.addInteger("games", stats.games);
+    jo.addInteger("failed", stats.failed);
+    jo.addDouble("wall_ms", wallNs / 1000000.0);
+    jo.addDouble("games_per_sec", stats.games * 1000000000.0 / wallNs);
+    jo.addObject("phases_ms_per_game", phases);
+    jo.addDouble("mahjong_steps_per_game", stats.mahjongSteps / played);
+    jo.addDouble("adventure_steps_per_game", stats.adventureSteps / played);
+    jo.addDouble("actions_per_game", stats.actions / played);
+    jo.addDouble("battles_per_game", stats.battles / played);
+    jo.addDouble("allocs_per_game", stats.allocs / played);
+    jo.addDouble("alloc_bytes_per_game", stats.allocBytes / played);
+    jo.addInteger("peak_rss_kb", peakRssKb(RUSAGE_SELF));
+
+    std::cerr << "games: " << stats.games << ", " << "games/sec: " << stats.games * 1000000000.0 / wallNs << std::endl;
+
+    if(output.empty())
+    {
+	std::cout << jo.toString() << std::endl;
+    }
+    else
+    if(! Systems::saveString2File(jo.toString(), output))
+    {
+	ERROR("save results error: " << output);
+	return EXIT_FAILURE;
+    }
+
+    return stats.failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    Systems::setLocale(LC_ALL, "");
+    Systems::setLocale(LC_NUMERIC, "C");
+
+    try
+    {
+	GameBench bench(argc, argv);
+	return bench.exec();
+    }
+    catch(Engine::exception &)
+    {
+    }
+
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,540 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <random>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+#include "gametheme.h"
+#include "aiturn.h"
+#include "aisearch.h"
+#include "battle.h"
+#include "gamestate.h"
+#include "benchmark.h"
+
+/* reproducible inputs: all generators use std::mt19937 with runner seed */
+namespace
+{
+    const size_t samplesCount = 256;
+
+    std::vector<int> stoneIds(void)
+    {
+	std::vector<int> res;
+	res.reserve(34);
+
+	for(int suit = 1; suit <= 3; ++suit)
+	    for(int order = 1; order <= 9; ++order)
+		res.push_back(suit * 10 + order);
+
+	for(int id = Stone::Wind1; id <= Stone::Wind4; ++id)
+	    res.push_back(id);
+
+	for(int id = Stone::Dragon1; id <= Stone::Dragon3; ++id)
+	    res.push_back(id);
+
+	return res;
+    }
+
+    Stone toStone(int id)
+    {
+	return Stone(static_cast<Stone::stone_t>(id));
+    }
+
+    VecStones shuffledWall(std::mt19937 & gen)
+    {
+	VecStones res;
+	res.reserve(136);
+
+	for(int ii = 0; ii < 4; ++ii)
+	    for(int id : stoneIds())
+		res.push_back(toStone(id));
+
+	std::shuffle(res.begin(), res.end(), gen);
+	return res;
+    }
+
+    // random deal: count stones from shuffled wall
+    GameStones randomHand(std::mt19937 & gen, size_t count)
+    {
+	VecStones wall = shuffledWall(gen);
+	GameStones res;
+
+	for(size_t it = 0; it < count && it < wall.size(); ++it)
+	    res.add(GameStone(wall[it], false));
+
+	return res;
+    }
+
+    // complete hand: 4 sets (pung or chao) and pair, 14 stones
+    Stones completeHand(std::mt19937 & gen)
+    {
+	const std::vector<int> ids = stoneIds();
+	std::uniform_int_distribution<int> anyStone(0, ids.size() - 1);
+	std::uniform_int_distribution<int> anySuit(1, 3);
+	std::uniform_int_distribution<int> anyOrder(1, 7);
+	std::bernoulli_distribution isPung(0.4);
+
+	while(true)
+	{
+	    std::vector<int> counts(60, 0);
+	    std::vector<int> res;
+	    res.reserve(14);
+
+	    for(int set = 0; set < 4; ++set)
+	    {
+		if(isPung(gen))
+		{
+		    int id = ids[anyStone(gen)];
+		    res.insert(res.end(), 3, id);
+		    counts[id] += 3;
+		}
+		else
+		{
+		    int id = anySuit(gen) * 10 + anyOrder(gen);
+		    for(int ii = 0; ii < 3; ++ii)
+		    {
+			res.push_back(id + ii);
+			counts[id + ii] += 1;
+		    }
+		}
+	    }
+
+	    int pair = ids[anyStone(gen)];
+	    res.insert(res.end(), 2, pair);
+	    counts[pair] += 2;
+
+	    if(std::all_of(counts.begin(), counts.end(), [](int val){ return val <= 4; }))
+	    {
+		Stones stones;
+		for(int id : res)
+		    stones.push_back(toStone(id));
+		return stones;
+	    }
+	}
+    }
+
+    LocalPlayer readyPlayer(std::mt19937 & gen)
+    {
+	Stones stones = completeHand(gen);
+	std::shuffle(stones.begin(), stones.end(), gen);
+
+	LocalPlayer player(RemotePlayer(Person(Avatar::Orachi, Clan::Red, Wind::East)));
+	player.newStone = GameStone(stones.back(), false);
+	stones.pop_back();
+
+	for(auto & st : stones)
+	    player.stones.add(GameStone(st, false));
+
+	return player;
+    }
+
+    LocalPlayer randomPlayer(std::mt19937 & gen)
+    {
+	GameStones stones = randomHand(gen, GAME_SET_COUNT + 1);
+
+	LocalPlayer player(RemotePlayer(Person(Avatar::Orachi, Clan::Red, Wind::East)));
+	player.newStone = GameStone(stones.del(stones.size() - 1), false);
+	player.stones = stones;
+
+	return player;
+    }
+
+    BattleParty randomParty(std::mt19937 & gen, const Clan & clan, const Land & land)
+    {
+	std::uniform_int_distribution<int> anyCreature(Creature::SkeletonHorde, Creature::Chameleon);
+	BattleParty party(clan, land);
+
+	for(int ii = 0; ii < 3; ++ii)
+	    party.join(static_cast<Creature::creature_t>(anyCreature(gen)));
+
+	return party;
+    }
+
+    template<typename T>
+    const T & sample(const std::vector<T> & samples, size_t it)
+    {
+	return samples[it % samples.size()];
+    }
+}
+
+void benchMahjong(Bench::Runner & runner)
+{
+    std::mt19937 gen(runner.seed());
+
+    // win check
+    std::vector<LocalPlayer> readyPlayers, randomPlayers;
+
+    for(size_t it = 0; it < samplesCount; ++it)
+    {
+	readyPlayers.push_back(readyPlayer(gen));
+	randomPlayers.push_back(randomPlayer(gen));
+    }
+
+    runner.add("LocalPlayer::isWinMahjong/ready", [=](size_t count)
+    {
+	for(size_t it = 0; it < count; ++it)
+	    Bench::doNotOptimize(sample(readyPlayers, it).isWinMahjong(Wind::East, Wind::East, Stone()));
+    });
+
+    runner.add("LocalPlayer::isWinMahjong/random", [=](size_t count)
+    {
+	for(size_t it = 0; it < count; ++it)
+	    Bench::doNotOptimize(sample(randomPlayers, it).isWinMahjong(Wind::East, Wind::East, Stone()));
+    });
+
+    // 12 stones without pair: complete sets, and random
+    std::vector<Stones> setsStones, randomStones;
+
+    for(size_t it = 0; it < samplesCount; ++it)
+    {
+	Stones stones = completeHand(gen);
+	stones.resize(12);
+	setsStones.push_back(stones);
+	randomStones.push_back(randomHand(gen, 12).toStones());
+    }
+
+    runner.add("WinRules::fromStones/sets", [=](size_t count)
+    {
+	for(size_t it = 0; it < count; ++it)
+	    Bench::doNotOptimize(WinRules::fromStones(sample(setsStones, it)));
+    });
+
+    runner.add("WinRules::fromStones/random", [=](size_t count)
+    {
+	for(size_t it = 0; it < count; ++it)
+	    Bench::doNotOptimize(WinRules::fromStones(sample(randomStones, it)));
+    });
+
+    // chao variants: random hand and suited drop stone
+    std::vector<std::pair<GameStones, Stone>> chaoSamples;
+    std::uniform_int_distribution<int> anySuit(1, 3);
+    std::uniform_int_distribution<int> anyOrder(1, 9);
+
+    for(size_t it = 0; it < samplesCount; ++it)
+	chaoSamples.emplace_back(randomHand(gen, GAME_SET_COUNT), toStone(anySuit(gen) * 10 + anyOrder(gen)));
+
+    runner.add("Stones::findChaoVariants", [=](size_t count)
+    {
+	for(size_t it = 0; it < count; ++it)
+	{
+	    auto & pair = sample(chaoSamples, it);
+	    Bench::doNotOptimize(pair.first.findChaoVariants(pair.second));
+	}
+    });
+
+    // cast checks: all spells and creatures runes
+    std::vector<Stones> castRules;
+
+    for(int id = Spell::Smoke; id <= Spell::MassDispel; ++id)
+    {
+	const SpellInfo & info = GameData::spellInfo(static_cast<Spell::spell_t>(id));
+	if(info.stones.size()) castRules.push_back(info.stones);
+    }
+
+    for(int id = Creature::SkeletonHorde; id <= Creature::Chameleon; ++id)
+    {
+	const CreatureInfo & info = GameData::creatureInfo(static_cast<Creature::creature_t>(id));
+	if(info.stones.size()) castRules.push_back(info.stones);
+    }
+
+    if(castRules.size())
+    {
+	runner.add("GameStones::allowCast", [=](size_t count)
+	{
+	    for(size_t it = 0; it < count; ++it)
+	    {
+		const LocalPlayer & player = sample(randomPlayers, it);
+		Bench::doNotOptimize(player.stones.allowCast(sample(castRules, it / samplesCount), player.newStone));
+	    }
+	});
+    }
+
+    // scoring: results from win hands
+    std::vector<WinResults> winResults;
+
+    for(auto & player : readyPlayers)
+    {
+	WinResults res;
+	if(player.isWinMahjong(Wind::East, Wind::East, Stone(), & res))
+	    winResults.push_back(res);
+    }
+
+    if(winResults.size())
+    {
+	runner.add("WinResults::calcBreakdown", [=](size_t count)
+	{
+	    ScoreBreakdown breakdown;
+
+	    for(size_t it = 0; it < count; ++it)
+	    {
+		sample(winResults, it).calcBreakdown(breakdown);
+		Bench::doNotOptimize(breakdown.totalScore);
+	    }
+	});
+
+	runner.add("WinResults::totalScore/cached", [=](size_t count)
+	{
+	    for(size_t it = 0; it < count; ++it)
+		Bench::doNotOptimize(sample(winResults, it).totalScore());
+	});
+
+	runner.add("WinResults::bonusDoubles/cached", [=](size_t count)
+	{
+	    for(size_t it = 0; it < count; ++it)
+		Bench::doNotOptimize(sample(winResults, it).bonusDoubles());
+	});
+    }
+
+    // lookahead claims: the new stone as discard of other player, undo must restore the state
+    std::vector<std::pair<GameState, StateMove>> stateSamples;
+
+    for(auto & player : readyPlayers)
+    {
+	GameState state{};
+	StatePlayer & sp = state.players[state.playersCount++];
+
+	sp.wind = player.wind();
+	for(auto & stone : player.stones)
+	    sp.hand.add(stone());
+
+	sp.hand.newStone = player.newStone();
+	state.dropStone = player.newStone();
+	state.currentWind = player.wind.prev()();
+
+	std::vector<StateMove> moves = { StateMove(StateMove::Pung, 0), StateMove(StateMove::Kong, 0), StateMove(StateMove::Kong2, 0) };
+	for(int first = state.dropStone - 2; first <= state.dropStone; ++first)
+	    moves.emplace_back(StateMove::Chao, 0, first);
+
+	for(auto & move : moves)
+	{
+	    GameState copy = state;
+	    StateUndo undo;
+
+	    if(! copy.apply(move, undo))
+		continue;
+
+	    copy.undo(undo);
+
+	    if(std::memcmp(& copy, & state, sizeof(state)))
+		ERROR("undo failed, move: " << static_cast<int>(move.type));
+	    else
+		stateSamples.emplace_back(state, move);
+	}
+    }
+
+    if(stateSamples.size())
+    {
+	runner.add("GameState::apply/undo", [=](size_t count)
+	{
+	    std::vector<std::pair<GameState, StateMove>> samples = stateSamples;
+	    StateUndo undo;
+
+	    for(size_t it = 0; it < count; ++it)
+	    {
+		auto & pair = samples[it % samples.size()];
+		Bench::doNotOptimize(pair.first.apply(pair.second, undo));
+		pair.first.undo(undo);
+	    }
+	});
+    }
+
+    // ai discard select: 14 stones, trash and open rules of other players
+    struct SelectSample
+    {
+	GameStones	stones;
+	TileTracker	tiles;
+	AI::OpponentModels opponents;
+    };
+
+    std::vector<SelectSample> selectSamples;
+    std::uniform_int_distribution<int> anyTrash(0, 40);
+
+    for(size_t it = 0; it < samplesCount; ++it)
+    {
+	SelectSample ss;
+	VecStones wall = shuffledWall(gen);
+	auto itwall = wall.begin();
+
+	for(int ii = 0; ii <= GAME_SET_COUNT; ++ii)
+	    ss.stones.add(GameStone(*itwall++, false));
+
+	int trash = anyTrash(gen);
+	for(int ii = 0; ii < trash; ++ii)
+	    ss.tiles.drop(winds_all.begin()[ii % 4], *itwall++);
+
+	Stones sets = completeHand(gen);
+	sets.resize(6);
+	for(auto & rule : WinRules::fromStones(sets))
+	    ss.tiles.expose(rule);
+
+	// left, top, right: open sets 1, 1, 0
+	for(int ii = 1; ii < 4; ++ii)
+	{
+	    AI::OpponentModel opp;
+	    opp.wind = winds_all.begin()[ii];
+	    opp.exposed = ii < 3 ? 1 : 0;
+	    opp.concealed = GAME_SET_COUNT - 3 * opp.exposed;
+	    opp.allowChao = 1 == ii;
+	    // samples are copied: no discards pointer
+	    ss.opponents.push_back(opp);
+	}
+
+	selectSamples.push_back(ss);
+    }
+
+    runner.add("AI::mahjongSelect", [=](size_t count)
+    {
+	for(size_t it = 0; it < count; ++it)
+	{
+	    auto & ss = sample(selectSamples, it);
+	    Bench::doNotOptimize(AI::mahjongSelect(ss.stones, ss.tiles, ss.opponents));
+	}
+    });
+
+    // ai discard search of the ui game: full depth 1, no time limit in reach
+    runner.add("AI::DiscardSearch::run/depth1", [=](size_t count)
+    {
+	for(size_t it = 0; it < count; ++it)
+	{
+	    auto & ss = sample(selectSamples, it);
+	    AI::DiscardSearch search(ss.stones, 4, ss.tiles, ss.opponents);
+	    Bench::doNotOptimize(search.run(AI::SearchLimits(1, 60000)));
+	}
+    });
+
+    // pending search reset: hard level search stopped right after start
+    runner.add("AI::PendingDrop/stop", [=](size_t count)
+    {
+	for(size_t it = 0; it < count; ++it)
+	{
+	    auto & ss = sample(selectSamples, it);
+	    auto search = std::make_shared<AI::DiscardSearch>(ss.stones, 4, ss.tiles, ss.opponents);
+	    const AI::SearchLimits limits = AI::searchLimits(2);
+	    AI::PendingDrop pending(Avatar::Orachi, search, std::async(std::launch::async, [=](){ return search->run(limits); }));
+	}
+    });
+}
+
+void benchAdventure(Bench::Runner & runner)
+{
+    std::mt19937 gen(runner.seed());
+
+    const std::vector<Land> lands(lands_all.begin(), lands_all.end());
+    std::uniform_int_distribution<int> anyLand(0, lands.size() - 1);
+
+    std::vector<std::pair<Land, Land>> paths;
+
+    while(paths.size() < samplesCount)
+    {
+	const Land & land1 = lands[anyLand(gen)];
+	const Land & land2 = lands[anyLand(gen)];
+	if(land1 != land2) paths.emplace_back(land1, land2);
+    }
+
+    runner.add("Lands::pathfind", [=](size_t count)
+    {
+	for(size_t it = 0; it < count; ++it)
+	{
+	    auto & pair = sample(paths, it);
+	    Bench::doNotOptimize(Lands::pathfind(pair.first, pair.second));
+	}
+    });
+
+    // battles: parties are copied before every attack (the attack is destructive)
+    struct BattleSample
+    {
+	BattleParty	attackers;
+	BattleParty	defenders;
+	BattleTown	town;
+    };
+
+    std::vector<BattleSample> battles;
+
+    for(size_t it = 0; it < samplesCount; ++it)
+    {
+	const Land & land = lands[anyLand(gen)];
+	battles.push_back({ randomParty(gen, Clan::Red, land), randomParty(gen, Clan::Yellow, land), BattleTown(land) });
+    }
+
+    runner.add("Battle::doAttackParty/town", [=](size_t count)
+    {
+	for(size_t it = 0; it < count; ++it)
+	{
+	    const BattleSample & bs = sample(battles, it);
+	    BattleParty attackers = bs.attackers;
+	    BattleTown town = bs.town;
+	    Bench::doNotOptimize(Battle::doAttackParty(attackers, town, nullptr, GameData::randomEngine()));
+	}
+    });
+
+    runner.add("Battle::doAttackParty/party", [=](size_t count)
+    {
+	for(size_t it = 0; it < count; ++it)
+	{
+	    const BattleSample & bs = sample(battles, it);
+	    BattleParty attackers = bs.attackers;
+	    BattleParty defenders = bs.defenders;
+	    BattleTown town = bs.town;
+	    Bench::doNotOptimize(Battle::doAttackParty(attackers, town, & defenders, GameData::randomEngine()));
+	}
+    });
+
+    // lanes: one call plays Matchup::Lanes battles of the sample
+    std::vector<Battle::Matchup> matchups;
+
+    for(auto & bs : battles)
+	matchups.emplace_back(bs.attackers, bs.town, & bs.defenders);
+
+    runner.add("Battle::Matchup::simulate/party x8", [=](size_t count)
+    {
+	for(size_t it = 0; it < count; ++it)
+	    Bench::doNotOptimize(sample(matchups, it).simulate(Battle::Matchup::Lanes, it));
+    });
+}
+
+int main(int argc, char **argv)
+{
+    Systems::setLocale(LC_ALL, "");
+    Systems::setLocale(LC_NUMERIC, "C");
+
+    try
+    {
+	Bench::Runner runner("rules", argc, argv);
+
+	if(! runner.initGameData())
+	    return EXIT_FAILURE;
+
+	// battles and ai: reproducible random
+	GameData::setRandomSeed(runner.seed());
+
+	benchMahjong(runner);
+	benchAdventure(runner);
+
+	return runner.exec();
+    }
+    catch(Engine::exception &)
+    {
+    }
+
+    return EXIT_FAILURE;
+}
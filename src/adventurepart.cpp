@@ -27,6 +27,7 @@
 #include "gametheme.h"
 #include "dialogs.h"
 #include "actions.h"
+#include "landmap.h"
 #include "adventurepart.h"
 
 enum { LandPolygonClickLeft = 1111, LandPolygonClickRight, LandPolygonFocus, LandPolygonFlagAnimationReInit, LandPolygonCombatStatus, LandPolygonCombatStatusReset,
@@ -34,9 +35,9 @@ enum { LandPolygonClickLeft = 1111, LandPolygonClickRight, LandPolygonFocus, Lan
 	MapScreenSelectLand,
 	AdventureTurnPlayer, AdventureTurnMoveStart, AdventureTurnMoveStop, AdventureTurnCreatureSelect, AdventureTurnShowConsole };
 
-LandPolygon::LandPolygon(const LandInfo & info, const JsonObject & jo, Window & win) : WindowToolTipArea(& win), landInfo(info), owner(info.clan), poly(info.points)
+LandPolygon::LandPolygon(const LandInfo & info, const JsonObject & jo, Window & win) : WindowToolTipArea(& win), landInfo(info), owner(GameData::landClan(info.id)), poly(info.points)
 {
-    Rect area = poly.around();
+    Rect area = GameData::landMap().bounds(info.id);
 
     setSize(area);
     setPosition(area);
@@ -71,7 +72,7 @@ LandPolygon::LandPolygon(const LandInfo & info, const JsonObject & jo, Window &
 
 bool LandPolygon::isAreaPoint(const Point & pos) const
 {
-    return Window::isAreaPoint(pos) ? poly & pos : false;
+    return Window::isAreaPoint(pos) ? GameData::landMap().landAt(pos) == landInfo.id : false;
 }
 
 void LandPolygon::animationsDisabled(bool f)
@@ -120,8 +121,9 @@ bool LandPolygon::userEvent(int act, void* data)
 	auto win = static_cast<const MapScreenBase*>(parent());
 	if(! win) return false;
 
-	const ClanInfo & clanInfo = GameData::clanInfo(landInfo.clan);
-    	const RemotePlayer & clanOwner = win->ld.playerOfClan(landInfo.clan);
+	const Clan landClan = GameData::landClan(landInfo.id);
+	const ClanInfo & clanInfo = GameData::clanInfo(landClan);
+    	const RemotePlayer & clanOwner = win->ld.playerOfClan(landClan);
 
 	const Sprite & sprite1 = GameTheme::texture(clanInfo.townflag1);
 	const Sprite & sprite2 = GameTheme::texture(clanInfo.townflag2);
@@ -139,7 +141,7 @@ bool LandPolygon::userEvent(int act, void* data)
 
 	// target event: fixed owner
 	if(data == & landInfo)
-	    owner = landInfo.clan;
+	    owner = GameData::landClan(landInfo.id);
 
 	renderWindow();
 	return true;
@@ -449,7 +451,7 @@ bool MapScreenBase::isAllowMoveFlag(const LandInfo & landInfo) const
 {
     const LocalPlayer & player = ld.myPlayer();
 
-    return (landInfo.id.isTowerWinds() || landInfo.clan == player.clan) && landInfo.id == selectedLand &&
+    return (landInfo.id.isTowerWinds() || GameData::landClan(landInfo.id) == player.clan) && landInfo.id == selectedLand &&
         0 < player.army.partySelected(landInfo.id).size();
 }
 
@@ -629,7 +631,7 @@ bool MapScreenBase::userEvent(int event, void* data)
 		    }
 		    else
 		    {
-			selectedClan = landInfo->clan;
+			selectedClan = GameData::landClan(landInfo->id);
 
 			bar1.setParty(selectedClan, GameData::getBattleArmy(selectedClan).findParty(selectedLand));
 			bar2.reset();
@@ -784,7 +786,7 @@ bool ShowSummonCreatureDialog::landAllowJoin(const LandInfo & info, const LocalP
         if(info.id.isTowerWinds())
 	    return true;
 	else
-	if(info.clan == player.clan)
+	if(GameData::landClan(info.id) == player.clan)
 	{
 	    const BattleParty* party = player.army.findPartyConst(info.id);
 	    return party ? party->canJoin() : true;
@@ -1106,7 +1108,7 @@ bool AdventurePartScreen::userEvent(int act, void* data)
 		const LandInfo & landInfo = GameData::landInfo(selectedLand);
 
 		// broadscast event: set combat status
-		if(player.clan != landInfo.clan)
+		if(player.clan != GameData::landClan(landInfo.id))
 		    DisplayScene::pushEvent(nullptr, LandPolygonCombatStatus, const_cast<LandInfo*>(& landInfo));
 
 		// broadscast event: update flags
@@ -1462,7 +1464,7 @@ bool AdventurePartScreen::actionDebugCommandParty(void)
     else
     {
         const LandInfo & land = GameData::landInfo(debugLand);
-        BattleArmy & army = GameData::getBattleArmy(land.clan);
+        BattleArmy & army = GameData::getBattleArmy(GameData::landClan(land.id));
         const BattleParty* party = army.findPartyConst(debugLand);
 
         if(party)
@@ -0,0 +1,518 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+
+#include "threadpool.h"
+#include "aimcts.h"
+
+namespace
+{
+    enum { PartyMax = 3, RoundsMax = 32 };
+
+    const float RewardScale = 1000;
+    const float Exploration = 0.7f;
+
+    Land toLand(int id)
+    {
+	return Land(static_cast<Land::land_t>(id));
+    }
+
+    BaseStat toBaseStat(const StateCreature & sc)
+    {
+	return BaseStat(sc.current[State::StatAttack], sc.current[State::StatRanger],
+			sc.current[State::StatDefense], sc.current[State::StatLoyalty]);
+    }
+
+    void applyDamage(StateCreature & sc, int damage)
+    {
+	sc.current[State::StatLoyalty] = std::max(0, sc.current[State::StatLoyalty] - damage);
+    }
+
+    /* see Battle::calculateDamage, without specialities */
+    int meleeDamage(int attack, int defense, int bonus, std::mt19937 & rng)
+    {
+	const int damage = attack - defense + std::max(0, bonus);
+
+	if(0 < damage)
+	    return damage;
+
+	// percents: 0, 1, 2, 3, 4, n
+	const int chances[] = { 50, 25, 12, 6, 3, 1 };
+	return std::uniform_int_distribution<int>(1, 100)(rng) <= chances[std::min(5, -damage)] ? 1 : 0;
+    }
+
+    template<typename Pred>
+    void removeCreatures(StatePlayer & sp, Pred pred)
+    {
+	int count = 0;
+
+	for(int it = 0; it < sp.armyCount; ++it)
+	    if(! pred(sp.army[it])) sp.army[count++] = sp.army[it];
+
+	sp.armyCount = count;
+    }
+
+    /* alive creatures of one clan on the land, army order */
+    struct StateParty
+    {
+	std::array<StateCreature*, PartyMax> units;
+	int			count;
+
+	StateParty(StatePlayer* sp, int land) : count(0)
+	{
+	    units.fill(nullptr);
+
+	    for(int it = 0; sp && it < sp->armyCount && count < PartyMax; ++it)
+		if(sp->army[it].land == land && sp->army[it].isAlive()) units[count++] = & sp->army[it];
+	}
+
+	int alive(void) const
+	{
+	    return std::count_if(units.begin(), units.begin() + count, [](const StateCreature* sc){ return sc->isAlive(); });
+	}
+
+	// melee bonus: alive creatures behind
+	int bonus(int pos) const
+	{
+	    return std::count_if(units.begin() + pos + 1, units.begin() + count, [](const StateCreature* sc){ return sc->isAlive(); });
+	}
+
+	int random(std::mt19937 & rng) const
+	{
+	    int num = alive();
+
+	    if(0 == num)
+		return -1;
+
+	    num = std::uniform_int_distribution<int>(0, num - 1)(rng);
+
+	    for(int it = 0; it < count; ++it)
+		if(units[it]->isAlive() && 0 == num--) return it;
+
+	    return -1;
+	}
+
+	void stat(BaseStat & res, int & num) const
+	{
+	    for(int it = 0; it < count; ++it)
+		if(units[it]->isAlive()) { res += toBaseStat(*units[it]); num += 1; }
+	}
+    };
+}
+
+struct AI::AdventureSearch::Node
+{
+    std::vector<Node>		children; // 0: stay, it: lands[it - 1] of the level party
+    uint32_t			visits;
+    float			reward;
+
+    Node() : visits(0), reward(0) {}
+
+    void merge(const Node & node)
+    {
+	visits += node.visits;
+	reward += node.reward;
+
+	if(children.empty())
+	    children = node.children;
+	else
+	if(children.size() == node.children.size())
+	{
+	    for(size_t it = 0; it < children.size(); ++it)
+		children[it].merge(node.children[it]);
+	}
+    }
+};
+
+int AI::adventureBudget(int level)
+{
+    // hard only: easy and normal keep the greedy planner
+    return 2 <= level ? 800 : 0;
+}
+
+AI::AdventureSearch::AdventureSearch(const GameState & gs, const Clan & clan, const std::vector<PartyMove> & moves)
+    : root(gs), player(gs.playerOfClan(clan())), parties(moves), rootValue(0), seed(GameData::randomEngine()()), cancel(false)
+{
+    costs.fill(0);
+    worths.fill(0);
+
+    // costs and worths cached; rollouts still read GameData::landInfo and landDistances:
+    // both filled before the first search and read only while the game runs, no lock needed
+    landDistances();
+
+    for(int it = Creature::SkeletonHorde; it <= Creature::Chameleon; ++it)
+	costs[it] = GameData::creatureInfo(Creature(static_cast<Creature::creature_t>(it))).cost;
+
+    for(auto & id : lands_all)
+	worths[id] = landWorth(Land(id));
+
+    // tree level by party
+    if(parties.size() > State::CreaturesMax)
+	parties.resize(State::CreaturesMax);
+
+    if(0 <= player)
+	rootValue = evaluate(root);
+}
+
+std::vector<CreatureMoved> AI::AdventureSearch::run(int budget, size_t threads) const
+{
+    std::vector<CreatureMoved> res;
+
+    if(0 > player || parties.empty())
+	return res;
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(budget);
+
+    // one pool for all searches: workers started once per process
+    static ThreadPool pool;
+    std::vector<Node> trees(threads ? std::min(threads, pool.size()) : pool.size());
+
+    for(size_t it = 0; it < trees.size(); ++it)
+    {
+	pool.push([this, it, deadline, & trees]()
+	{
+	    std::mt19937 rng(seed + it);
+
+	    // budget checked after every playout: a playout is tens of microseconds, the clock read is not
+	    do iterate(trees[it], rng);
+	    while(! cancel && std::chrono::steady_clock::now() < deadline);
+	});
+    }
+
+    pool.wait();
+
+    Node merged;
+    for(auto & tree : trees)
+	merged.merge(tree);
+
+    DEBUG("playouts: " << merged.visits << ", " << "trees: " << trees.size());
+
+    // most visited choice by level
+    const Node* node = & merged;
+
+    for(size_t level = 0; level < parties.size() && node->children.size(); ++level)
+    {
+	auto best = std::max_element(node->children.begin(), node->children.end(),
+				[](const Node & node1, const Node & node2){ return node1.visits < node2.visits; });
+	const int choice = std::distance(node->children.begin(), best);
+
+	if(choice)
+	{
+	    for(auto & unit : parties[level].units)
+		res.emplace_back(unit, parties[level].lands[choice - 1]);
+	}
+
+	node = & (*best);
+    }
+
+    return res;
+}
+
+void AI::AdventureSearch::iterate(Node & tree, std::mt19937 & rng) const
+{
+    std::array<Node*, State::CreaturesMax + 1> path;
+    std::array<int, State::CreaturesMax> choices;
+
+    Node* node = & tree;
+    int depth = 0;
+    size_t level = 0;
+
+    path[depth++] = node;
+
+    // selection by uct down to a new node
+    while(level < parties.size())
+    {
+	if(node->children.empty())
+	    node->children.resize(parties[level].lands.size() + 1);
+
+	const float logVisits = std::log(static_cast<float>(node->visits + 1));
+	float bestScore = -1;
+	int choice = 0;
+
+	for(size_t it = 0; it < node->children.size(); ++it)
+	{
+	    const Node & child = node->children[it];
+	    const float score = child.visits ?
+		child.reward / child.visits + Exploration * std::sqrt(logVisits / child.visits) : std::numeric_limits<float>::max();
+
+	    if(bestScore < score)
+	    {
+		bestScore = score;
+		choice = it;
+	    }
+	}
+
+	choices[level++] = choice;
+	node = & node->children[choice];
+	path[depth++] = node;
+
+	if(0 == node->visits)
+	    break;
+    }
+
+    // rollout: other parties stay or move at random
+    for(; level < parties.size(); ++level)
+	choices[level] = rng() % 2 ? 0 : 1 + rng() % parties[level].lands.size();
+
+    const float reward = playout(choices.data(), rng);
+
+    for(int it = 0; it < depth; ++it)
+    {
+	path[it]->visits += 1;
+	path[it]->reward += reward;
+    }
+}
+
+float AI::AdventureSearch::playout(const int* choices, std::mt19937 & rng) const
+{
+    const LandDistances & distances = landDistances();
+    GameState state = root;
+    StateUndo undo;
+
+    for(size_t level = 0; level < parties.size(); ++level)
+	if(choices[level])
+    {
+	const PartyMove & pm = parties[level];
+	const Land & land = pm.lands[choices[level] - 1];
+	const int hops = distances(pm.from, land);
+
+	for(auto & unit : pm.units)
+	{
+	    const int slot = state.players[player].findCreature(unit);
+	    if(0 <= slot) state.apply(StateMove(StateMove::MoveCreature, player, slot, land(), hops), undo);
+	}
+    }
+
+    resolveBattles(state, player, rng);
+
+    // next clans of this adventure part
+    for(int wind = state.players[player].wind + 1; wind <= Wind::North; ++wind)
+    {
+	const int other = state.playerOfWind(wind);
+
+	if(0 <= other)
+	{
+	    opponentMoves(state, other, rng);
+	    resolveBattles(state, other, rng);
+	}
+    }
+
+    const float reward = 0.5f + (evaluate(state) - rootValue) / (2 * RewardScale);
+    return std::max(0.0f, std::min(1.0f, reward));
+}
+
+void AI::AdventureSearch::opponentMoves(GameState & state, int other, std::mt19937 & rng) const
+{
+    StatePlayer & sp = state.players[other];
+    uint64_t done = 0;
+    StateUndo undo;
+
+    for(int it = 0; it < sp.armyCount; ++it)
+    {
+	const int from = sp.army[it].land;
+
+	if(done & (1ULL << from))
+	    continue;
+
+	done |= 1ULL << from;
+
+	BaseStat stat;
+	int units = 0;
+	int move = std::numeric_limits<int>::max();
+
+	for(int pos = 0; pos < sp.armyCount; ++pos)
+	    if(sp.army[pos].land == from && sp.army[pos].isAlive())
+	{
+	    stat += toBaseStat(sp.army[pos]);
+	    units += 1;
+	    move = std::min(move, static_cast<int>(sp.army[pos].current[State::StatMove]));
+	}
+
+	if(0 == units || 0 >= move)
+	    continue;
+
+	// best border attack
+	int target = Land::None;
+	float best = 0;
+
+	for(auto & border : GameData::landInfo(toLand(from)).borders)
+	    if(! border.isTowerWinds() && state.owners[border()] != sp.clan && sp.partySize(border()) + units <= PartyMax)
+	{
+	    BaseStat def = GameData::landInfo(border).stat;
+	    int num = 1;
+
+	    const int owner = state.playerOfClan(state.owners[border()]);
+	    if(0 <= owner) StateParty(& state.players[owner], border()).stat(def, num);
+
+	    const float chance = battleChance(stat, units, def, num);
+
+	    if(best < chance)
+	    {
+		best = chance;
+		target = border();
+	    }
+	}
+
+	// sure attacks mostly, risky ones seldom
+	if(target == Land::None || std::uniform_real_distribution<float>(0, 1)(rng) >= best * best)
+	    continue;
+
+	for(int pos = 0; pos < sp.armyCount; ++pos)
+	    if(sp.army[pos].land == from && sp.army[pos].isAlive())
+		state.apply(StateMove(StateMove::MoveCreature, other, pos, target, 1), undo);
+
+	done |= 1ULL << target;
+    }
+}
+
+void AI::AdventureSearch::resolveBattles(GameState & state, int attacker, std::mt19937 & rng) const
+{
+    const StatePlayer & sp = state.players[attacker];
+    uint64_t lands = 0;
+
+    for(int it = 0; it < sp.armyCount; ++it)
+    {
+	const StateCreature & sc = sp.army[it];
+
+	// skip public zone
+	if(sc.isAlive() && sc.land != Land::TowerOf4Winds && state.owners[sc.land] != sp.clan)
+	    lands |= 1ULL << sc.land;
+    }
+
+    for(int land = 0; lands; ++land)
+	if(lands & (1ULL << land))
+    {
+	lands &= ~(1ULL << land);
+	resolveBattle(state, attacker, land, rng);
+    }
+}
+
+void AI::AdventureSearch::resolveBattle(GameState & state, int attacker, int land, std::mt19937 & rng) const
+{
+    StatePlayer & sp1 = state.players[attacker];
+    const int defender = state.playerOfClan(state.owners[land]);
+    StatePlayer* sp2 = 0 <= defender && defender != attacker ? & state.players[defender] : nullptr;
+
+    const TownStat & town = GameData::landInfo(toLand(land)).stat;
+    int townLoyalty = town.loyalty;
+
+    StateParty party1(& sp1, land);
+    StateParty party2(sp2, land);
+
+    // ranged round: town, then attackers and defenders
+    if(0 < town.ranger)
+    {
+	const int pos = party1.random(rng);
+	if(0 <= pos) applyDamage(*party1.units[pos], town.ranger);
+    }
+
+    for(int it = 0; it < party1.count; ++it)
+	if(party1.units[it]->isAlive() && 0 < party1.units[it]->current[State::StatRanger])
+    {
+	const int pos = party2.random(rng);
+	if(0 <= pos) applyDamage(*party2.units[pos], party1.units[it]->current[State::StatRanger]);
+    }
+
+    for(int it = 0; it < party2.count; ++it)
+	if(party2.units[it]->isAlive() && 0 < party2.units[it]->current[State::StatRanger])
+    {
+	const int pos = party1.random(rng);
+	if(0 <= pos) applyDamage(*party1.units[pos], party2.units[it]->current[State::StatRanger]);
+    }
+
+    // melee rounds: land holder strikes first
+    for(int round = 0; round < RoundsMax && party1.alive() && 0 < townLoyalty; ++round)
+    {
+	if(party2.alive())
+	{
+	    for(int it = 0; it < party2.count; ++it)
+	    {
+		StateCreature & unit = *party2.units[it];
+		const int pos = party1.random(rng);
+
+		if(! unit.isAlive() || 0 > pos)
+		    continue;
+
+		StateCreature & target = *party1.units[pos];
+		applyDamage(target, meleeDamage(unit.current[State::StatAttack], target.current[State::StatDefense], party2.bonus(it), rng));
+
+		if(target.isAlive())
+		    applyDamage(unit, meleeDamage(target.current[State::StatAttack], unit.current[State::StatDefense], party1.bonus(pos), rng));
+	    }
+	}
+	else
+	{
+	    StateCreature & target = *party1.units[party1.random(rng)];
+	    applyDamage(target, meleeDamage(town.attack, target.current[State::StatDefense], 0, rng));
+
+	    if(target.isAlive())
+		townLoyalty -= meleeDamage(target.current[State::StatAttack], town.defense, 0, rng);
+	}
+    }
+
+    if(0 >= townLoyalty)
+    {
+	state.owners[land] = sp1.clan;
+	if(sp2) removeCreatures(*sp2, [=](const StateCreature & sc){ return sc.land == land; });
+    }
+    else
+	removeCreatures(sp1, [=](const StateCreature & sc){ return sc.land == land; });
+
+    removeCreatures(sp1, [](const StateCreature & sc){ return ! sc.isAlive(); });
+    if(sp2) removeCreatures(*sp2, [](const StateCreature & sc){ return ! sc.isAlive(); });
+}
+
+float AI::AdventureSearch::evaluate(const GameState & state) const
+{
+    const StatePlayer & sp = state.players[player];
+    float res = 0;
+
+    // own towns and alive army by summon cost
+    for(auto & id : lands_all)
+	if(state.owners[id] == sp.clan) res += worths[id];
+
+    for(int it = 0; it < sp.armyCount; ++it)
+	if(sp.army[it].isAlive()) res += costs[sp.army[it].creature];
+
+    return res;
+}
+
+bool AI::adventurePendingMoves(ActionList & actions)
+{
+    GameSession & gs = GameData::session();
+    std::shared_ptr<PendingMoves> pending = gs.aiMoves;
+
+    if(! pending || std::future_status::ready != pending->moves.wait_for(std::chrono::milliseconds(0)))
+	return false;
+
+    gs.aiMoves.reset();
+
+    // units checked again by moveCreature
+    for(auto & move : pending->moves.get())
+	GameData::client2Adventure(pending->avatar, ClientUnitMoved(move.first, move.second), actions);
+
+    return true;
+}
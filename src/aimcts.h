@@ -0,0 +1,90 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef _RWNA_AIMCTS_
+#define _RWNA_AIMCTS_
+
+#include <array>
+#include <atomic>
+#include <random>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "gamestate.h"
+#include "aiturn.h"
+
+namespace AI
+{
+    /* adventure tree search time, ms: 0 greedy planner */
+    int				adventureBudget(int level);
+
+    /* planning time of one clan inside the server tick, ms: four ai clans fit one 16 ms frame */
+    enum { AdventureFrameBudget = 4 };
+
+    /* monte carlo tree search over the party moves of one clan:
+       tree level by party, rollouts play battles and the next clans on a state copy */
+    class AdventureSearch
+    {
+	struct Node;
+
+	GameState		root;
+	int			player;
+	std::vector<PartyMove>	parties;
+	std::array<int, 256>	costs;	// creature cost by id
+	std::array<int, Land::SiphonsChute + 1> worths;
+	float			rootValue;
+	unsigned int		seed;
+	std::atomic<bool>	cancel;
+
+	void			iterate(Node &, std::mt19937 &) const;
+	float			playout(const int* choices, std::mt19937 &) const;
+	void			opponentMoves(GameState &, int other, std::mt19937 &) const;
+	void			resolveBattles(GameState &, int attacker, std::mt19937 &) const;
+	void			resolveBattle(GameState &, int attacker, int land, std::mt19937 &) const;
+	float			evaluate(const GameState &) const;
+
+    public:
+	AdventureSearch(const GameState &, const Clan &, const std::vector<PartyMove> &);
+
+	// root parallel trees on shared thread pool, 0: tree per core
+	std::vector<CreatureMoved> run(int budget, size_t threads = 0) const;
+	// any thread: trees return after the current playout
+	void			stop(void) { cancel = true; }
+    };
+
+    /* search for ui game, result taken on a later server tick; reset stops the search */
+    struct PendingMoves
+    {
+	Avatar			avatar;
+	std::shared_ptr<AdventureSearch> search;
+	std::future<std::vector<CreatureMoved>> moves;
+
+	PendingMoves(const Avatar & av, const std::shared_ptr<AdventureSearch> & as, std::future<std::vector<CreatureMoved>> && res)
+	    : avatar(av), search(as), moves(std::move(res)) {}
+	~PendingMoves() { search->stop(); }
+    };
+
+    bool			adventurePendingMoves(ActionList &);
+}
+
+#endif
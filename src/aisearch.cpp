@@ -0,0 +1,417 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include <cmath>
+#include <algorithm>
+
+#include "aisearch.h"
+
+namespace GameData
+{
+    LocalPlayer &	playerOfAvatar(const Avatar &);
+    bool		client2Mahjong(const Avatar &, const ClientMessage &, ActionList &);
+}
+
+namespace
+{
+    const float WinValue = 1;
+    // float rounding of equal expectations summed in other order: values up to 2 * sets
+    const float ExpectEpsilon = 1e-5f;
+
+    /* melds, partial sets and pair decomposition, suits only link by id + 1, id + 2 */
+    struct ShantenScan
+    {
+	RuneCounts &		counts;
+	int			sets;
+	int			best;
+
+	ShantenScan(RuneCounts & rc, int num) : counts(rc), sets(num), best(2 * num) {}
+
+	void			scan(int id, int melds, int partial, int pair);
+    };
+
+    void ShantenScan::scan(int id, int melds, int partial, int pair)
+    {
+	while(id <= Stone::Dragon3 && 0 == counts[id]) id++;
+
+	if(id > Stone::Dragon3)
+	{
+	    best = std::min(best, 2 * sets - 2 * melds - partial - pair);
+	    return;
+	}
+
+	// complete: nothing better
+	if(best < 0)
+	    return;
+
+	const bool suited = id <= Stone::Number9;
+	const int order = id % 10;
+
+	if(melds + partial < sets)
+	{
+	    // pung
+	    if(2 < counts[id])
+	    {
+		counts[id] -= 3;
+		scan(id, melds + 1, partial, pair);
+		counts[id] += 3;
+	    }
+
+	    // chao
+	    if(suited && order < 8 && counts[id + 1] && counts[id + 2])
+	    {
+		counts[id]--; counts[id + 1]--; counts[id + 2]--;
+		scan(id, melds + 1, partial, pair);
+		counts[id]++; counts[id + 1]++; counts[id + 2]++;
+	    }
+
+	    // partial pung
+	    if(1 < counts[id])
+	    {
+		counts[id] -= 2;
+		scan(id, melds, partial + 1, pair);
+		counts[id] += 2;
+	    }
+
+	    // partial chao: [1] 2, [1] _ 3
+	    if(suited && order < 9 && counts[id + 1])
+	    {
+		counts[id]--; counts[id + 1]--;
+		scan(id, melds, partial + 1, pair);
+		counts[id]++; counts[id + 1]++;
+	    }
+
+	    if(suited && order < 8 && counts[id + 2])
+	    {
+		counts[id]--; counts[id + 2]--;
+		scan(id, melds, partial + 1, pair);
+		counts[id]++; counts[id + 2]++;
+	    }
+	}
+
+	// game pair
+	if(! pair && 1 < counts[id])
+	{
+	    counts[id] -= 2;
+	    scan(id, melds, partial, 1);
+	    counts[id] += 2;
+	}
+
+	// single stone
+	counts[id]--;
+	scan(id, melds, partial, pair);
+	counts[id]++;
+    }
+}
+
+int AI::handShanten(RuneCounts & counts, int sets)
+{
+    ShantenScan scan(counts, sets);
+    scan.scan(Stone::Skull1, 0, 0, 0);
+    return scan.best;
+}
+
+AI::SearchLimits AI::searchLimits(int level)
+{
+    switch(level)
+    {
+	case 0:		return SearchLimits(0, 0);
+	case 1:		return SearchLimits(2, 200);
+	default: break;
+    }
+
+    return SearchLimits(3, 800);
+}
+
+AI::DiscardSearch::DiscardSearch(const GameStones & stones, int num, const TileTracker & tiles, const OpponentModels & opponents)
+    : hand(stones.stonesCount()), pool(0), sets(num), nodes(0), timeout(false), cancel(false)
+{
+    const TileOdds odds(stones, tiles);
+
+    unseen = odds.unseen;
+    pool = odds.pool;
+    penalty.fill(0);
+
+    // one-ply heuristic: tie-break between equal expectations only
+    for(auto & stone : stones)
+	penalty[stone()] = keepCost(stones, stone, tiles, odds, opponents);
+}
+
+bool AI::DiscardSearch::outOfTime(void)
+{
+    if(! timeout && 0 == (++nodes & 0x0F))
+	timeout = cancel || deadline < std::chrono::steady_clock::now();
+
+    return timeout;
+}
+
+float AI::DiscardSearch::decision(int depth)
+{
+    // each node: one shanten per distinct stone
+    if(outOfTime())
+	return 0;
+
+    if(-1 == handShanten(hand, sets))
+	return WinValue;
+
+    float best = -2 * sets;
+
+    for(auto & id : stones_all)
+    {
+	if(0 == hand[id])
+	    continue;
+
+	hand[id]--;
+	best = std::max(best, chance(depth));
+	hand[id]++;
+
+	if(timeout)
+	    break;
+    }
+
+    return best;
+}
+
+float AI::DiscardSearch::chance(int depth)
+{
+    if(0 == depth || 0 == pool)
+	return -handShanten(hand, sets);
+
+    float res = 0;
+    const float total = pool;
+
+    for(auto & id : stones_all)
+    {
+	if(0 == unseen[id])
+	    continue;
+
+	const float prob = unseen[id] / total;
+
+	hand[id]++; unseen[id]--; pool--;
+	res += prob * decision(depth - 1);
+	hand[id]--; unseen[id]++; pool++;
+
+	if(timeout)
+	    break;
+    }
+
+    return res;
+}
+
+int AI::DiscardSearch::run(const SearchLimits & limits)
+{
+    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(limits.budget);
+    int res = Stone::None;
+    int done = -1;
+
+    // iterative deepening: keep the last complete iteration
+    for(int depth = 0; depth <= limits.depth && ! timeout; ++depth)
+    {
+	int stone = Stone::None;
+	float best = 0;
+
+	for(auto & id : stones_all)
+	{
+	    if(0 == hand[id])
+		continue;
+
+	    hand[id]--;
+	    float val = chance(depth);
+	    hand[id]++;
+
+	    if(timeout)
+		break;
+
+	    // keep cost decides between equal expectations only
+	    const bool equal = std::fabs(val - best) <= ExpectEpsilon;
+
+	    if(Stone::None == stone || (! equal && best < val) || (equal && penalty[id] < penalty[stone]))
+	    {
+		stone = id;
+		best = val;
+	    }
+	}
+
+	if(! timeout)
+	{
+	    res = stone;
+	    done = depth;
+	}
+    }
+
+    DEBUG("depth: " << done << ", " << "nodes: " << nodes << ", " << "stone: " << Stone(static_cast<Stone::stone_t>(res)).toString());
+    return res;
+}
+
+namespace
+{
+    // best shanten after one drop: 3k+2 hand
+    int discardShanten(RuneCounts & counts, int sets)
+    {
+	int res = 2 * sets;
+
+	for(auto & id : stones_all)
+	{
+	    if(0 == counts[id])
+		continue;
+
+	    counts[id]--;
+	    res = std::min(res, AI::handShanten(counts, sets));
+	    counts[id]++;
+	}
+
+	return res;
+    }
+}
+
+float AI::gameChance(int shanten, int draws)
+{
+    if(shanten < 0)
+	return 1;
+
+    // rough: each step halves the chance, too few draws for the steps left
+    float steps = shanten + 1;
+    return std::ldexp(1.0f, -(shanten + 1)) * std::min(1.0f, (draws + 1) / (4 * steps));
+}
+
+int AI::projectedScore(const LocalPlayer & player, const WinRules & exposed, const Stones & concealed, const Wind & roundWind, const Stone & lastStone)
+{
+    // sets already in hand as concealed, self drawn game
+    const WinResults res(player.wind, player.wind, roundWind, exposed, WinRules::fromStones(concealed), Stone(), lastStone);
+    return res.breakdown().totalScore;
+}
+
+AI::ClaimChoice AI::claimChoice(const LocalPlayer & player, const Wind & currentWind, const Wind & roundWind, const Stone & dropStone, int draws)
+{
+    ClaimChoice res;
+
+    const int sets = 4 - player.rules.size();
+    RuneCounts counts = player.stones.stonesCount();
+    const int id = dropStone();
+
+    // pass: concealed hand, 3k+1
+    res.value = gameChance(handShanten(counts, sets), draws) *
+			projectedScore(player, player.rules, player.stones.toStones(), roundWind, dropStone);
+
+    if(0 == sets)
+	return res;
+
+    auto claimValue = [&](const WinRule & rule, const Stones & removed, int shanten)
+    {
+	WinRules exposed = player.rules;
+	exposed << rule;
+
+	Stones concealed = player.stones.toStones();
+	for(auto & st : removed)
+	    concealed.removeStone(st);
+
+	return gameChance(shanten, draws) * projectedScore(player, exposed, concealed, roundWind, dropStone);
+    };
+
+    if(player.isMahjongKong1(currentWind, dropStone))
+    {
+	// replacement stone follows: 3k+1
+	counts[id] -= 3;
+	float value = claimValue(WinRule(WinRule::Kong, dropStone, false), Stones() << dropStone << dropStone << dropStone, handShanten(counts, sets - 1));
+	counts[id] += 3;
+
+	if(res.value < value)
+	{
+	    res.rule = WinRule::Kong;
+	    res.value = value;
+	}
+    }
+
+    if(player.isMahjongPung(currentWind, dropStone))
+    {
+	// drop follows: 3k+2
+	counts[id] -= 2;
+	float value = claimValue(WinRule(WinRule::Pung, dropStone, false), Stones() << dropStone << dropStone, discardShanten(counts, sets - 1));
+	counts[id] += 2;
+
+	if(res.value < value)
+	{
+	    res.rule = WinRule::Pung;
+	    res.value = value;
+	}
+    }
+
+    if(player.isMahjongChao(currentWind, dropStone))
+    {
+	const Stones variants = player.stones.findChaoVariants(dropStone);
+
+	for(int it = 0; it < static_cast<int>(variants.size()); ++it)
+	{
+	    const Stone & first = variants[it];
+	    Stones removed;
+
+	    for(auto & st : { first, first.next(), first.next().next() })
+		if(st != dropStone) removed << st;
+
+	    for(auto & st : removed) counts[st()]--;
+	    float value = claimValue(WinRule(WinRule::Chao, first, false), removed, discardShanten(counts, sets - 1));
+	    for(auto & st : removed) counts[st()]++;
+
+	    if(res.value < value)
+	    {
+		res.rule = WinRule::Chao;
+		res.variant = it;
+		res.value = value;
+	    }
+	}
+    }
+
+    DEBUG(player.toString() << ", " << "drop stone: " << dropStone.toString() << ", " << "claim: " << res.rule << ", " << "value: " << res.value);
+    return res;
+}
+
+int AI::dropIndex(const GameStones & stones, int stone)
+{
+    // casted stones sorted first
+    auto it = std::find_if(stones.begin(), stones.end(), [=](const GameStone & gs){ return gs.id() == stone; });
+
+    return it != stones.end() ? std::distance(stones.begin(), it) : -1;
+}
+
+bool AI::mahjongPendingDrop(ActionList & actions)
+{
+    GameSession & gs = GameData::session();
+    std::shared_ptr<PendingDrop> pending = gs.aiSearch;
+
+    if(! pending || std::future_status::ready != pending->stone.wait_for(std::chrono::milliseconds(0)))
+	return false;
+
+    gs.aiSearch.reset();
+
+    const LocalPlayer & player = GameData::playerOfAvatar(pending->avatar);
+    const int stone = pending->stone.get();
+    int index = dropIndex(player.stones, stone);
+
+    if(0 > index)
+    {
+	ERROR("search stone not in hand: " << stone << ", " << player.toString());
+	index = mahjongSelect(player.stones, gs.tiles, opponentModels(player.wind, gs.tiles));
+    }
+
+    return GameData::client2Mahjong(pending->avatar, ClientDropIndex(index), actions);
+}
@@ -0,0 +1,110 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#ifndef _RWNA_AISEARCH_
+#define _RWNA_AISEARCH_
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+
+#include "aiturn.h"
+
+namespace AI
+{
+    /* distance to game: -1 complete, sets: concealed sets needed */
+    int				handShanten(RuneCounts &, int sets);
+
+    struct SearchLimits
+    {
+	int			depth;	// future draws
+	int			budget;	// ms, 0: one-ply select
+
+	SearchLimits(int d = 0, int ms = 0) : depth(d), budget(ms) {}
+    };
+
+    /* difficulty level: 0 easy, 1 normal, 2 hard */
+    SearchLimits		searchLimits(int level);
+
+    /* expectimax over draw/discard with iterative deepening, all state copied on start */
+    class DiscardSearch
+    {
+	RuneCounts		hand;
+	RuneCounts		unseen;
+	int			pool;
+	int			sets;
+	std::array<int, 64>	penalty; // keep cost by stone id
+
+	std::chrono::steady_clock::time_point deadline;
+	size_t			nodes;
+	bool			timeout;
+	std::atomic<bool>	cancel;
+
+	bool			outOfTime(void);
+	float			decision(int depth);
+	float			chance(int depth);
+
+    public:
+	DiscardSearch(const GameStones &, int sets, const TileTracker &, const OpponentModels &);
+
+	// best stone id to drop, Stone::None: stopped before the first iteration
+	int			run(const SearchLimits &);
+	// any thread: run returns on the next time check
+	void			stop(void) { cancel = true; }
+    };
+
+    /* claim or pass for drop stone: expected score with and without the open set */
+    struct ClaimChoice
+    {
+	int			rule;	 // WinRule: None, Chao, Pung, Kong
+	int			variant; // chao variant index
+	float			value;	 // game chance * projected score
+
+	ClaimChoice() : rule(WinRule::None), variant(-1), value(0) {}
+    };
+
+    float			gameChance(int shanten, int draws);
+    int				projectedScore(const LocalPlayer &, const WinRules & exposed, const Stones & concealed,
+					    const Wind & roundWind, const Stone & lastStone);
+    ClaimChoice			claimChoice(const LocalPlayer &, const Wind & currentWind, const Wind & roundWind,
+					    const Stone & dropStone, int draws);
+
+    /* search for ui game, result taken on next server tick; reset stops the search */
+    struct PendingDrop
+    {
+	Avatar			avatar;
+	std::shared_ptr<DiscardSearch> search;
+	std::future<int>	stone;
+
+	PendingDrop(const Avatar & av, const std::shared_ptr<DiscardSearch> & ds, std::future<int> && res)
+	    : avatar(av), search(ds), stone(std::move(res)) {}
+	~PendingDrop() { search->stop(); }
+    };
+
+    // -1: stone not in hand
+    int				dropIndex(const GameStones &, int stone);
+    bool			mahjongPendingDrop(ActionList &);
+}
+
+#endif
@@ -21,23 +21,30 @@
  ***************************************************************************/
 
 #include <set>
+#include <chrono>
+#include <limits>
 #include <random>
 #include <algorithm>
 
-#include "aiturn.h"
+#include "settings.h"
+#include "aisearch.h"
+#include "aimcts.h"
+#include "landmap.h"
 
 namespace GameData
 {
-    extern LocalPlayers gamers;
-
     LocalPlayer &	playerOfAvatar(const Avatar &);
     LocalPlayer &	playerOfClan(const Clan &);
     LocalPlayer &	playerOfWind(const Wind &);
     bool		client2Mahjong(const Avatar &, const ClientMessage &, ActionList &);
+
+    extern int		bonusPass;
+    extern int		bonusChao;
+    extern int		bonusPung;
+    extern int		bonusKong;
 }
 
-bool AI::mahjongTurn(const Wind & currentWind, const Avatar & avatar, const VecStones & trash,
-    const WinRules & left, const WinRules & right, const WinRules & top, bool showGame, bool showKong, ActionList & actions)
+bool AI::mahjongTurn(const Wind & currentWind, const Avatar & avatar, bool showGame, bool showKong, ActionList & actions)
 {
     // simple AI
     actions.push_back(MahjongTurn(currentWind, Stone(), false, false));
@@ -56,12 +63,6 @@ bool AI::mahjongTurn(const Wind & currentWind, const Avatar & avatar, const VecS
 	return true;
     }
 
-    // AI select
-    WinRules other; other.reserve(12);
-    other.insert(other.end(), left.begin(), left.end());
-    other.insert(other.end(), right.begin(), right.end());
-    other.insert(other.end(), top.begin(), top.end());
-
     LocalPlayer & player = GameData::playerOfAvatar(avatar);
 
     if(player.newStone.isValid())
@@ -70,7 +71,7 @@ bool AI::mahjongTurn(const Wind & currentWind, const Avatar & avatar, const VecS
 	player.newStone = GameStone(Stone::None, true);
     }
 
-    // cast or summon
+    // cast or summon: new stone already in hand, runes tables see the hand only
     const AvatarInfo & avatarInfo = GameData::avatarInfo(avatar);
 
     if(! player.isCasted())
@@ -83,176 +84,331 @@ bool AI::mahjongTurn(const Wind & currentWind, const Avatar & avatar, const VecS
 	{
     	    const CreatureInfo & creatureInfo = GameData::creatureInfo(cr);
 
-	    // allow summon
-	    if(creatureInfo.cost <= player.points &&
-		player.stones.allowCast(creatureInfo.stones)) summons.push_back(creatureInfo.id);
+	    // allow summon: points checked by planner
+	    if(player.allowSummonRunes(creatureInfo.id)) summons.push_back(creatureInfo.id);
 	}
 
-	// allow cast spells
+	// allow cast spells: avatar and army casters
 	for(auto & sp : avatarInfo.spells)
-	{
-    	    const SpellInfo & spellInfo = GameData::spellInfo(sp);
+	    if(player.allowCastSpell(sp)) casts.push_back(sp);
 
-	    // allow cast
-	    if(spellInfo.cost <= player.points &&
-		player.stones.allowCast(spellInfo.stones)) casts.push_back(spellInfo.id);
-	}
+	for(auto & sp : player.army.allCastSpells())
+	    if(player.allowCastSpell(sp) && casts.end() == std::find(casts.begin(), casts.end(), sp)) casts.push_back(sp);
 
 	if(summons.size() || casts.size())
 	    mahjongSummonCast(avatar, summons, casts, actions);
     }
 
     // drop stone
-    int dropIndex = mahjongSelect(player.stones, trash, other);
+    const TileTracker & tiles = GameData::session().tiles;
+    const OpponentModels opponents = opponentModels(currentWind, tiles);
+    const SearchLimits limits = searchLimits(Settings::aiLevel());
+    GameSession & gs = GameData::session();
+
+    // ui game: search outside the server tick, drop taken by mahjong2Client
+    if(0 < limits.budget && ! gs.gamers.isAllAI())
+    {
+	auto search = std::make_shared<DiscardSearch>(player.stones, 4 - player.rules.size(), tiles, opponents);
+	gs.aiSearch = std::make_shared<PendingDrop>(avatar, search, std::async(std::launch::async, [=](){ return search->run(limits); }));
+	return true;
+    }
+
+    int dropIndex = mahjongSelect(player.stones, tiles, opponents);
     return GameData::client2Mahjong(avatar, ClientDropIndex(dropIndex), actions);
 }
 
-struct ArmyFullHousePredicate
+namespace
 {
-    const BattleArmy &army;
+    // average summon price of one stat point for this avatar
+    int statPrice(const AvatarInfo & avatarInfo)
+    {
+	int cost = 0;
+	int stat = 0;
 
-    ArmyFullHousePredicate(const BattleArmy & a) : army(a)
+	for(auto & cr : avatarInfo.creatures)
+	{
+	    const CreatureInfo & creatureInfo = GameData::creatureInfo(cr);
+	    cost += creatureInfo.cost;
+	    stat += creatureInfo.stat.attack + creatureInfo.stat.ranger + creatureInfo.stat.defense + creatureInfo.stat.loyalty;
+	}
+
+	return 0 < stat ? std::max(1, cost / stat) : 10;
+    }
+
+    // spell effect on one creature, in points
+    int unitWorth(const SpellInfo & spellInfo, const BattleCreature & bcr, int price)
     {
+	if(bcr.isAffectedSpell(spellInfo.id))
+	    return 0;
+
+	const BaseStat & effect = spellInfo.effect;
+	int res = 0;
+
+	switch(spellInfo.id())
+	{
+	    case Spell::Paralyze:
+		res = (bcr.attack() + bcr.ranger()) * price;
+		break;
+
+	    case Spell::Healing:
+		res = std::min(effect.loyalty, bcr.baseLoyalty() - bcr.loyalty()) * price;
+		break;
+
+	    case Spell::LightningBolt:
+	    case Spell::HellBlast:
+		// vanquished: full summon cost
+		res = bcr.loyalty() <= -effect.loyalty ?
+			GameData::creatureInfo(bcr).cost : -effect.loyalty * price;
+		break;
+
+	    default:
+		res = std::abs(effect.attack + effect.ranger + effect.defense + effect.loyalty) * price;
+		break;
+	}
+
+	return bcr.haveSpeciality(Speciality::MagicResistence) ? res / 2 : res;
     }
+}
+
+AI::LandMaps::LandMaps(const Clan & clan)
+{
+    threat.fill(0);
+    guard.fill(0);
+    frontier.fill(0);
 
-    bool operator() (const Land & land) const
+    for(auto & lp : GameData::session().gamers)
+	for(auto & party : lp.army)
     {
-	const BattleParty* bp = army.findPartyConst(land);
-	return bp && ! bp->canJoin();
+	const BaseStat stat = party.toBaseStatSummary();
+	const Land & land = party.land();
+
+	if(lp.clan == clan)
+	    guard[land()] += stat.defense + stat.loyalty;
+	else
+	{
+	    const int power = stat.attack + stat.ranger;
+	    threat[land()] += power;
+
+	    for(auto & border : GameData::landInfo(land).borders)
+		threat[border()] += power;
+	}
     }
-};
 
-void AI::mahjongSummonCast(const Avatar & avatar, const Creatures & summons, const Spells & casts, ActionList & actions)
+    for(auto & land : Lands::thisClan(clan))
+    {
+	const LandInfo & landInfo = GameData::landInfo(land);
+	guard[land()] += landInfo.stat.defense + landInfo.stat.loyalty;
+
+	for(auto & border : landInfo.borders)
+	    if(GameData::landClan(border) != clan)
+		frontier[land()] = std::max(frontier[land()], GameData::landInfo(border).stat.point);
+    }
+}
+
+int AI::LandMaps::need(const Land & land) const
 {
-    const LocalPlayer & player = GameData::playerOfAvatar(avatar);
+    // percent: threatened land guard first, border land attack
+    int res = 100 + frontier[land()] / 10;
+
+    if(threat[land()] > guard[land()])
+	res += 50;
+
+    return res;
+}
+
+AI::CastPlan AI::planSummon(const LocalPlayer & player, const Creature & creature, const LandMaps & maps, int price)
+{
+    CastPlan res;
+    const CreatureInfo & creatureInfo = GameData::creatureInfo(creature);
+
+    if(player.isAffectedSpell(Spell::Silence) || player.army.isMaximumSummoning() ||
+	(creatureInfo.unique && GameData::findCreatureUnique(creature)))
+	return res;
 
-    FIXME("fixme add AI person priority action(cast or summon) to json...");
-    bool summonPriority = summons.size();
-    bool castPriority = false;
+    const int power = creatureInfo.stat.attack + creatureInfo.stat.ranger + creatureInfo.stat.defense + creatureInfo.stat.loyalty;
 
-    if(summonPriority)
+    for(auto & land : Lands::thisClan(player.clan).powerOnly())
     {
-	Lands powerLands = Lands::thisClan(player.clan).powerOnly();
-	if(powerLands.size())
-	{
-	    const ArmyFullHousePredicate armyFullHouse(player.army);
+	const BattleParty* party = player.army.findPartyConst(land);
 
-	    // remove powerLands: if army full house
-	    powerLands.resize(std::distance(powerLands.begin(),
-			std::remove_if(powerLands.begin(), powerLands.end(), armyFullHouse)));
+	if(party ? ! party->canJoin() : player.army.isFullHouse())
+	    continue;
 
-	    if(powerLands.size())
-	    {
-		auto land = Tools::random_n(powerLands.begin(), powerLands.end());
-		auto creature = Tools::random_n(summons.begin(), summons.end());
+	int score = power * price * maps.need(land) / 100 - creatureInfo.cost;
 
-		GameData::client2Mahjong(avatar, ClientSummonCreature(*creature, *land), actions);
-		castPriority = false;
-	    }
-	    else
-	    {
-		DEBUG("summon false, powerLands is full house");
-		castPriority = true;
-	    }
-	}
-	else
+	if(! res.isValid() || res.score < score)
 	{
-	    DEBUG("summon false, powerLands not found");
-	    castPriority = true;
+	    res.creature = creature;
+	    res.land = land;
+	    res.score = score;
 	}
     }
 
-    if(castPriority)
+    res.cost = creatureInfo.cost;
+    return res;
+}
+
+AI::CastPlan AI::planCast(const LocalPlayer & player, const Spell & spell, const LandMaps & maps, int price)
+{
+    CastPlan res;
+    const SpellInfo & spellInfo = GameData::spellInfo(spell);
+    const SpellTarget & target = spellInfo.target;
+
+    res.spell = spell;
+    res.cost = spellInfo.cost;
+    res.score = -spellInfo.cost;
+
+    auto better = [&](int worth, const Land & land, int unit)
     {
-	DEBUG("cast spell priority");
+	if(res.score < worth - spellInfo.cost)
+	{
+	    res.score = worth - spellInfo.cost;
+	    res.land = land;
+	    res.unit = unit;
+	}
+    };
+
+    if(target() == SpellTarget::MyPlayer)
+    {
+	// draw suit: worth for a hand in this suit
+	const int type = Spell::DrawSkull == spell() ? StoneType::IsSkull :
+			    (Spell::DrawSword == spell() ? StoneType::IsSword : StoneType::IsNumber);
+	int suited = 0;
+
+	for(auto & stone : player.stones)
+	    if(stone.stoneType() & type) suited++;
 
-	auto spell = Tools::random_n(casts.begin(), casts.end());
+	res.score = GameData::bonusPung * suited / 4 - spellInfo.cost;
+    }
+    else
+    if(target() & SpellTarget::AllPlayers)
+    {
+	// hurt the player nearest to game
+	int exposed = -1;
 
-	if(spell != casts.end())
+	for(auto & other : GameData::session().gamers)
 	{
-	    const SpellInfo & spellInfo = GameData::spellInfo(*spell);
+	    if(other.clan == player.clan)
+		continue;
 
-	    BattleTargets targets;
+	    if(Spell::Silence == spell() && GameData::avatarInfo(other.avatar).ability() == Ability::Telepath)
+		continue;
 
-	    for(auto & other : GameData::gamers)
+	    if(exposed < static_cast<int>(other.rules.size()))
 	    {
-		for(auto & tgt : other.toBattleTargets())
-		{
-		    switch(spellInfo.target())
-		    {
-			case SpellTarget::Land: // Any | Party
-			    targets << tgt;
-			    break;
-
-			case SpellTarget::Enemy:
-			    if(player.clan != other.clan) targets << tgt;
-			    break;
-
-			case SpellTarget::Friendly:
-			    if(player.clan == other.clan) targets << tgt;
-			    break;
-
-			case SpellTarget::Party:
-
-			case SpellTarget::Any: // Friendly | Enemy
-			case SpellTarget::MyPlayer:
-			case SpellTarget::OtherPlayer:
-			case SpellTarget::AllPlayers:
-			default: break;
-		    }
-		}
+		exposed = other.rules.size();
+		res.target = other.avatar;
 	    }
-/*
-    BattleTargets targets;
-    targets.reserve(10);
+	}
 
-    if(spellInfo.target() == SpellTarget::Land)
-    {
-	for(auto it = GameData::gamers.begin(); it != GameData::gamers.end(); ++it)
+	// scry runes: no gain for ai
+	if(0 <= exposed && Spell::ScryRunes != spell())
 	{
-	    auto party = (*it).army.findPartyConst(land);
-	    if(party) targets << party->toBattleTargets((*it).clan);
+	    const int worth = GameData::bonusPung * (1 + exposed);
+	    res.score = (target() == SpellTarget::AllPlayers ? worth - GameData::bonusPung * player.rules.size() : worth) - spellInfo.cost;
 	}
     }
     else
-    if(spellInfo.target() & SpellTarget::Party)
     {
-	if(spellInfo.target() & SpellTarget::Friendly)
+	for(auto & other : GameData::session().gamers)
+	    for(auto & party : other.army)
 	{
-	    auto party = client.army.findPartyConst(land);
-	    if(party) targets << party->toBattleTargets(client.clan);
-	}
-	else
-	if(spellInfo.target() & SpellTarget::Enemy)
-	{
-	    for(auto it = GameData::gamers.begin(); it != GameData::gamers.end(); ++it)
-	        if(client.clan != (*it).clan)
+	    const bool enemy = other.clan != player.clan;
+	    const int need = enemy ? 100 : maps.need(party.land());
+	    int partyWorth = 0;
+
+	    for(auto & bcr : party.toBattleCreatures())
 	    {
-		auto party = (*it).army.findPartyConst(land);
-		if(party) targets << party->toBattleTargets((*it).clan);
+		if(! bcr)
+		    continue;
+
+		int worth = unitWorth(spellInfo, *bcr, price) * need / 100;
+
+		// single creature
+		if(((target() & SpellTarget::Enemy) && enemy) || ((target() & SpellTarget::Friendly) && ! enemy))
+		{
+		    if(! (target() & SpellTarget::Party))
+			better(worth, party.land(), bcr->battleUnit());
+		}
+
+		partyWorth += enemy ? worth : -worth;
 	    }
+
+	    // party: enemy only, land: all parties
+	    if(target() == SpellTarget::Land)
+		better(partyWorth, party.land(), 0);
+	    else
+	    if((target() & SpellTarget::Party) && enemy)
+		better(partyWorth, party.land(), 0);
 	}
     }
-    else
-    if(unit)
+
+    return res;
+}
+
+void AI::mahjongSummonCast(const Avatar & avatar, const Creatures & summons, const Spells & casts, ActionList & actions)
+{
+    const LocalPlayer & player = GameData::playerOfAvatar(avatar);
+
+    // board maps once for all candidates
+    const LandMaps maps(player.clan);
+    const int price = statPrice(GameData::avatarInfo(avatar));
+
+    CastPlan best;
+    CastPlan wait;
+
+    auto consider = [&](const CastPlan & plan)
     {
-	BattleCreature* bcr = nullptr;
+	if(plan.isValid() && 0 < plan.score)
+	{
+	    CastPlan & slot = plan.cost <= player.points ? best : wait;
+	    if(! slot.isValid() || slot.score < plan.score) slot = plan;
+	}
+    };
+
+    for(auto & cr : summons)
+	consider(planSummon(player, cr, maps, price));
+
+    for(auto & sp : casts)
+	consider(planCast(player, sp, maps, price));
+
+    // save points: a better plan after a few turns of pass and claim bonuses
+    if(wait.isValid())
+    {
+	const int income = std::max(1, GameData::bonusPass + (GameData::bonusChao + GameData::bonusPung + GameData::bonusKong) / 3);
+	const int turns = (wait.cost - player.points + income - 1) / income;
+	int score = wait.score;
+
+	for(int it = 0; it < turns; ++it)
+	    score = score * 9 / 10;
 
-	for(auto it = GameData::gamers.begin(); it != GameData::gamers.end() && !bcr; ++it)
+	if(! best.isValid() || best.score < score)
 	{
-	    auto party = (*it).army.findParty(land);
-	    bcr = party ? party->findBattleUnit(unit) : nullptr;
-	    if(bcr) targets.push_back(BattleTarget(bcr, (*it).clan, land));
+	    DEBUG("save points: " << player.points << ", " << "wait turns: " << turns);
+	    return;
 	}
     }
-*/
 
-	    // Spell spell;
-	    // Land land;
-	    // BattleTarget uid;
-	    // GameData::client2Mahjong(avatar, ClientCastSpell(spell, land, uid, actions);
-	}
+    if(! best.isValid())
+	return;
+
+    DEBUG("score: " << best.score << ", " << "cost: " << best.cost);
+
+    if(best.creature.isValid())
+    {
+	GameData::client2Mahjong(avatar, ClientSummonCreature(best.creature, best.land), actions);
+	return;
     }
+
+    const SpellInfo & spellInfo = GameData::spellInfo(best.spell);
+
+    if(spellInfo.target() == SpellTarget::AllPlayers || spellInfo.target() == SpellTarget::MyPlayer)
+	GameData::client2Mahjong(avatar, ClientCastSpell(best.spell), actions);
+    else
+    if(spellInfo.target() == SpellTarget::OtherPlayer)
+	GameData::client2Mahjong(avatar, ClientCastSpell(best.spell, best.target), actions);
+    else
+	GameData::client2Mahjong(avatar, ClientCastSpell(best.spell, best.land, best.unit), actions);
 }
 
 void AI::mahjongOtherPass(const Wind & currentWind, ActionList & actions, const Wind & skip)
@@ -288,49 +444,55 @@ bool AI::mahjongGameKongPungChao(const Wind & currentWind, const Wind & roundWin
 	}
     }
 
-    // set kong, pung
+    // claim choices: ai seats with a legal claim only, most discards have none
+    const int draws = GameData::session().stoneLastCount / 4;
+    std::array<ClaimChoice, Wind::North + 1> choices;
+
     for(auto & id : winds_all)
     {
-	if(id == currentWind())
-		continue;
+	const LocalPlayer & playerAI = GameData::playerOfWind(id);
+
+	if(id == currentWind() || ! playerAI.isAI())
+	    continue;
+
+	if(playerAI.isMahjongKong1(currentWind, dropStone) || playerAI.isMahjongPung(currentWind, dropStone) ||
+	    playerAI.isMahjongChao(currentWind, dropStone))
+	    choices[id] = claimChoice(playerAI, currentWind, roundWind, dropStone, draws);
+    }
 
+    // set kong, pung
+    for(auto & id : winds_all)
+    {
 	LocalPlayer & playerAI = GameData::playerOfWind(id);
 
-	if(playerAI.isAI())
+	if(WinRule::Kong == choices[id].rule)
 	{
-	    if(playerAI.isMahjongKong1(currentWind, dropStone))
-	    {
-		if(sayOnly)
-		    return GameData::client2Mahjong(playerAI.avatar, ClientSayKong(2), actions);
-		else
-		    return GameData::client2Mahjong(playerAI.avatar, ClientButtonKong1(), actions);
-	    }
+	    if(sayOnly)
+		return GameData::client2Mahjong(playerAI.avatar, ClientSayKong(2), actions);
 	    else
-	    if(playerAI.isMahjongPung(currentWind, dropStone))
-	    {
-		if(sayOnly)
-		    return GameData::client2Mahjong(playerAI.avatar, ClientSayPung(), actions);
-		else
-		    return GameData::client2Mahjong(playerAI.avatar, ClientButtonPung(), actions);
-	    }
+		return GameData::client2Mahjong(playerAI.avatar, ClientButtonKong1(), actions);
+	}
+	else
+	if(WinRule::Pung == choices[id].rule)
+	{
+	    if(sayOnly)
+		return GameData::client2Mahjong(playerAI.avatar, ClientSayPung(), actions);
+	    else
+		return GameData::client2Mahjong(playerAI.avatar, ClientButtonPung(), actions);
 	}
     }
 
     // set chao
     for(auto & id : winds_all)
     {
-	if(id == currentWind())
-	    continue;
-
 	LocalPlayer & playerAI = GameData::playerOfWind(id);
 
-	if(playerAI.isAI() &&
-	    playerAI.isMahjongChao(currentWind, dropStone))
+	if(WinRule::Chao == choices[id].rule)
 	{
 	    if(sayOnly)
 		return GameData::client2Mahjong(playerAI.avatar, ClientSayChao(), actions);
 	    else
-		return GameData::client2Mahjong(playerAI.avatar, ClientChaoVariant(255), actions);
+		return GameData::client2Mahjong(playerAI.avatar, ClientChaoVariant(choices[id].variant), actions);
 	}
     }
 
@@ -349,80 +511,179 @@ struct StoneCost
     bool		operator< (const StoneCost & sc) const { return cost < sc.cost; }
 };
 
-int AI::mahjongSelect(const GameStones & stones, const VecStones & trash, const WinRules & other)
+namespace
 {
-    std::multiset<StoneCost> result;
+    double combinations(int n, int k)
+    {
+	if(k < 0 || k > n)
+	    return 0;
 
-    for(auto it = stones.begin(); it != stones.end(); ++it)
+	double res = 1;
+	for(int it = 1; it <= k; ++it)
+	    res = res * (n - k + it) / it;
+
+	return res;
+    }
+}
+
+AI::OpponentModel::OpponentModel(const LocalPlayer & player, const Wind & discarder, const TileTracker & tiles)
+    : wind(player.wind), concealed(player.stones.size()), exposed(player.rules.size()),
+    allowChao(player.wind == discarder.next()), discards(& tiles.discards[player.wind()])
+{
+}
+
+AI::OpponentModels AI::opponentModels(const Wind & currentWind, const TileTracker & tiles)
+{
+    OpponentModels res;
+    res.reserve(3);
+
+    for(auto & id : winds_all)
+	if(id != currentWind())
+	    res.emplace_back(GameData::playerOfWind(id), currentWind, tiles);
+
+    return res;
+}
+
+AI::TileOdds::TileOdds(const GameStones & own, const TileTracker & tiles) : pool(0)
+{
+    for(auto & id : stones_all)
+    {
+	unseen[id] = tiles.unseen(id, own);
+	pool += unseen[id];
+    }
+}
+
+float AI::TileOdds::holdAtLeast(const Stone & stone, int count, int hand) const
+{
+    // hypergeometric: hand stones from pool, copies of stone in pool
+    const int copies = unseen[stone()];
+    const int other = pool - copies;
+
+    if(count > copies || count > hand || hand > pool)
+	return 0;
+
+    // 1 - sum P(x), x < count: P(x) = C(copies, x) * C(other, hand - x) / C(pool, hand)
+    double below = 0;
+    for(int x = 0; x < count; ++x)
+	below += combinations(copies, x) * combinations(other, hand - x);
+
+    below /= combinations(pool, hand);
+    return below < 1 ? 1 - below : 0;
+}
+
+float AI::TileOdds::danger(const Stone & stone, const OpponentModel & opp) const
+{
+    // pung or kong claim
+    float claim = holdAtLeast(stone, 2, opp.concealed);
+
+    // chao claim: next player only
+    if(opp.allowChao && ! stone.isSpecial())
     {
-	const GameStone & stone = *it;
-	int cost = 100;
+	const Stone prev1 = stone.prev();
+	const Stone prev2 = prev1.prev();
+	const Stone next1 = stone.next();
+	const Stone next2 = next1.next();
 
-	int count1 = std::count(stones.begin(), stones.end(), stone);
-	int count2 = std::count(trash.begin(), trash.end(), stone) + std::count(other.begin(), other.end(), stone);
+	auto hold = [&](const Stone & st){ return st.isValid() ? holdAtLeast(st, 1, opp.concealed) : 0.0f; };
+	float none = (1 - hold(prev2) * hold(prev1)) * (1 - hold(prev1) * hold(next1)) * (1 - hold(next1) * hold(next2));
 
-	// winds and dragons
-	if(stone.isSpecial())
-	{
-	    // check: possible pung or kong
-	    if(1 < count1)
-	    {
-		if(3 < count1 + count2)
-		    cost -= 20 * count2;
-		else
-		    cost += 20 * count1;
-	    }
-	}
-	else
-	{
-	    // check: possible pung or kong
-	    if(1 < count1)
-	    {
-		if(3 < count1 + count2)
-		    cost -= 10 * count2;
-		else
-		    cost += 10 * count1;
-	    }
+	claim = 1 - (1 - claim) * none;
+    }
 
-	    // check: possible chao
-	    switch(stone.order())
-	    {
-    		case 1: // [1] 2 3
-		cost += 10 * ((stones.findStone(stone.next()) ? 1 : 0) +
-				    (stones.findStone(stone.next().next()) ? 1 : 0));
-		break;
+    // ready hand: more open sets, closer to game
+    float ready = std::min(1.0f, (opp.exposed + 1) / 4.0f);
 
-    		case 2: // 1 [2] 3, [2] 3 4
-		cost += 10 * ((stones.findStone(stone.prev()) ? 1 : 0) + (stones.findStone(stone.next()) ? 1 : 0) +
-				    (stones.findStone(stone.next().next()) ? 1 : 0));
-		break;
+    // the opponent dropped this stone itself
+    if(opp.discards && (*opp.discards)[stone()])
+	ready *= 0.5f;
 
-    	    	case 3: // 1 2 [3], 2 [3] 4, [3] 4 5
-    		case 4: // 2 3 [4], 3 [4] 5, [4] 5 6
-    		case 5: // 3 4 [5], 4 [5] 6, [5] 6 7
-    		case 6: // 4 5 [6], 5 [6] 7, [6] 7 8
-    		case 7: // 5 6 [7], 6 [7] 8, [7] 8 9
-		cost += 10 * ((stones.findStone(stone.prev().prev()) ? 1 : 0) + (stones.findStone(stone.prev()) ? 1 : 0) +
-				    (stones.findStone(stone.next()) ? 1 : 0) + (stones.findStone(stone.next().next()) ? 1 : 0));
-		break;
+    return claim * ready;
+}
 
-    		case 8: // 6 7 [8], 7 [8] 9
-		cost += 10 * ((stones.findStone(stone.prev().prev()) ? 1 : 0) + (stones.findStone(stone.prev()) ? 1 : 0) +
-				    (stones.findStone(stone.next()) ? 1 : 0));
-		break;
+int AI::keepCost(const GameStones & stones, const Stone & stone, const TileTracker & tiles, const TileOdds & odds, const OpponentModels & opponents)
+{
+    int cost = 100;
 
-    		case 9: // 7 8 [9]
-		cost += 10 * ((stones.findStone(stone.prev().prev()) ? 1 : 0) +
-				    (stones.findStone(stone.prev()) ? 1 : 0));
-		break;
+    int count1 = stones.countStone(stone);
+    int count2 = tiles.seen[stone()];
 
-		default: break;
-	    }
+    // deal-in danger
+    float danger = 0;
+    for(auto & opp : opponents)
+	danger += odds.danger(stone, opp);
+
+    cost += static_cast<int>(40 * danger);
+
+    // winds and dragons
+    if(stone.isSpecial())
+    {
+	// check: possible pung or kong
+	if(1 < count1)
+	{
+	    if(3 < count1 + count2)
+		cost -= 20 * count2;
+	    else
+		cost += 20 * count1;
+	}
+    }
+    else
+    {
+	// check: possible pung or kong
+	if(1 < count1)
+	{
+	    if(3 < count1 + count2)
+		cost -= 10 * count2;
+	    else
+		cost += 10 * count1;
 	}
 
-	result.emplace(stone, std::distance(stones.begin(), it), cost);
+	// check: possible chao
+	switch(stone.order())
+	{
+	    case 1: // [1] 2 3
+	    cost += 10 * ((stones.findStone(stone.next()) ? 1 : 0) +
+				(stones.findStone(stone.next().next()) ? 1 : 0));
+	    break;
+
+	    case 2: // 1 [2] 3, [2] 3 4
+	    cost += 10 * ((stones.findStone(stone.prev()) ? 1 : 0) + (stones.findStone(stone.next()) ? 1 : 0) +
+				(stones.findStone(stone.next().next()) ? 1 : 0));
+	    break;
+
+	    case 3: // 1 2 [3], 2 [3] 4, [3] 4 5
+	    case 4: // 2 3 [4], 3 [4] 5, [4] 5 6
+	    case 5: // 3 4 [5], 4 [5] 6, [5] 6 7
+	    case 6: // 4 5 [6], 5 [6] 7, [6] 7 8
+	    case 7: // 5 6 [7], 6 [7] 8, [7] 8 9
+	    cost += 10 * ((stones.findStone(stone.prev().prev()) ? 1 : 0) + (stones.findStone(stone.prev()) ? 1 : 0) +
+				(stones.findStone(stone.next()) ? 1 : 0) + (stones.findStone(stone.next().next()) ? 1 : 0));
+	    break;
+
+	    case 8: // 6 7 [8], 7 [8] 9
+	    cost += 10 * ((stones.findStone(stone.prev().prev()) ? 1 : 0) + (stones.findStone(stone.prev()) ? 1 : 0) +
+				(stones.findStone(stone.next()) ? 1 : 0));
+	    break;
+
+	    case 9: // 7 8 [9]
+	    cost += 10 * ((stones.findStone(stone.prev().prev()) ? 1 : 0) +
+				(stones.findStone(stone.prev()) ? 1 : 0));
+	    break;
+
+	    default: break;
+	}
     }
 
+    return cost;
+}
+
+int AI::mahjongSelect(const GameStones & stones, const TileTracker & tiles, const OpponentModels & opponents)
+{
+    std::multiset<StoneCost> result;
+    const TileOdds odds(stones, tiles);
+
+    for(auto it = stones.begin(); it != stones.end(); ++it)
+	result.emplace(*it, std::distance(stones.begin(), it), keepCost(stones, *it, tiles, odds, opponents));
+
     if(result.size())
     {
 	auto itbeg = result.begin();
@@ -431,8 +692,7 @@ int AI::mahjongSelect(const GameStones & stones, const VecStones & trash, const
 	std::vector<StoneCost> rnd; rnd.reserve(8);
 	std::copy(itbeg, itend, std::back_inserter(rnd));
 
-        std::random_device rd;
-        std::mt19937 mtg(rd());
+        std::mt19937 & mtg = GameData::randomEngine();
 	std::shuffle(rnd.begin(), rnd.end(), mtg);
 
 	// first find casted
@@ -444,98 +704,309 @@ int AI::mahjongSelect(const GameStones & stones, const VecStones & trash, const
     }
 
     // impossible ;)
-    return Tools::rand(0, stones.size());
+    return GameData::random(0, stones.size());
 }
 
-namespace AI
+AI::LandDistances::LandDistances()
 {
-    Lands findTargetsFor(const BaseStat &, const Clan &);
+    const LandMap & map = GameData::landMap();
+
+    for(int from = 0; from < static_cast<int>(hops.size()); ++from)
+	for(int to = 0; to < static_cast<int>(hops.size()); ++to)
+	    hops[from][to] = map.hops(Land(static_cast<Land::land_t>(from)), Land(static_cast<Land::land_t>(to)));
 }
 
-Lands AI::findTargetsFor(const BaseStat & bs, const Clan & clan)
+int AI::LandDistances::operator() (const Land & from, const Land & to) const
 {
-    Lands res;
+    return hops[from()][to()];
+}
 
-    for(auto & land : Lands::enemyAroundOnly(clan))
-	if(! land.isTowerWinds())
-    {
-	const LandInfo & landInfo = GameData::landInfo(land);
-	BaseStat stat = landInfo.stat;
+const AI::LandDistances & AI::landDistances(void)
+{
+    // lands graph is read only catalog
+    static const LandDistances distances;
+    return distances;
+}
 
-	const BattleParty* party = GameData::getBattleArmy(clan).findPartyConst(land);
-	if(party)
-	    stat += party->toBaseStatSummary();
+float AI::battleChance(const BaseStat & att, int units1, const BaseStat & def, int units2)
+{
+    if(0 >= units1 || 0 >= att.loyalty)
+	return 0;
 
-	if(bs.loyalty > stat.attack - bs.defense + stat.ranger &&
-	    stat.loyalty < bs.attack - stat.defense + bs.ranger)
-	    res.push_back(land);
-    }
+    if(0 >= units2)
+	return 1;
 
-    return res;
+    // rounds each side needs, hit against average defense of the side
+    const float hit1 = std::max(0.5f, att.attack + att.ranger - def.defense / static_cast<float>(units2));
+    const float hit2 = std::max(0.5f, def.attack + def.ranger - att.defense / static_cast<float>(units1));
+
+    const float rounds1 = def.loyalty / hit1;
+    const float rounds2 = att.loyalty / hit2;
+
+    return rounds2 / (rounds1 + rounds2);
 }
 
-void AI::adventureMove(const RemotePlayer & player, ActionList & actions)
+int AI::landWorth(const Land & land)
 {
-    // FIXME: army
-    // toLocalData(const Avatar &)
+    const TownStat & stat = GameData::landInfo(land).stat;
+    return stat.point + (stat.power ? 100 : 0);
+}
 
-/*
-    Lands Lands::pathfind(const Land &, const Land &);
-    Lands Lands::thisClan(const Clan &);
-    Lands Lands::enemyAroundOnly(const Clan &);
+namespace
+{
+    /* one battle side: town counts as one unit */
+    struct Force
+    {
+	BaseStat		stat;
+	int			units;
+	int			cost;
 
-    const BattleParty* party = player.army.findPartyConst(*it);
-*/
+	Force() : units(0), cost(0) {}
 
-    for(auto & party : player.army)
+	void			add(const BaseStat & bs, int price) { stat += bs; units += 1; cost += price; }
+	void			add(const Force & force) { stat += force.stat; units += force.units; cost += force.cost; }
+    };
+
+    Force partyForce(const AI::PartyMove & pm)
     {
-	if(party.moveTarget().isValid())
-	{
-	    Lands path = Lands::pathfind(party.land(), party.moveTarget());
+	Force res;
+	res.stat = pm.stat;
+	res.units = pm.units.size();
+	res.cost = pm.cost;
+	return res;
+    }
 
-	    if(path.empty())
-	    {
-		ERROR("path is empty" << ", " << "from: " << party.land().toString() << ", " << "to: " << party.moveTarget().toString());
+    /* per turn board for one clan: defenders, planned attackers and occupancy by land */
+    struct AdventureBoard
+    {
+	typedef std::array<Force, Land::SiphonsChute + 1> LandForces;
+
+	Clan			clan;
+	AI::LandMaps		maps;
+	LandForces		defenders;
+	LandForces		attackers;
+	AI::LandMaps::LandValues occupied;
+
+	AdventureBoard(const RemotePlayer &);
+
+	bool			isEnemy(const Land & land) const { return GameData::landClan(land) != clan; }
+	int			attackValue(const Force &, const Land &) const;
+	int			exposure(const Land &, int guard) const;
+	int			nextAttack(const Force &, const Land &) const;
+	int			moveValue(const AI::PartyMove &, const Land &) const;
+	void			commit(const AI::PartyMove &, const Land &);
+    };
+
+    AdventureBoard::AdventureBoard(const RemotePlayer & player) : clan(player.clan), maps(player.clan)
+    {
+	occupied.fill(0);
+
+	for(auto & id : lands_all)
+	{
+	    const Land land(id);
+	    if(land.isTowerWinds())
 		continue;
-	    }
 
-	    if(1 < party.movePoint() && 1 < path.size())
+	    if(isEnemy(land))
 	    {
-		//const CreatureInfo & info = GameData::creatureInfo(*it);
-		bool info_fly = true;
+		defenders[id].add(GameData::landInfo(land).stat, 0);
 
-		if(info_fly)
-		{
-		    // move to path[1]
-		}
-		else
-		{
-		    // if clan != path[0] move to path[0] else path[1]
-		}
-	    }
-	    else
-	    if(0 < party.movePoint())
-	    {
-		// move to path.front()
-		// client2Adventure(avatar, ClientUnitMoved((*it).first, (*it).second), actions);
+		const LocalPlayer* other = GameData::session().gamers.playerOfClan(GameData::landClan(land));
+		const BattleParty* party = other ? other->army.findPartyConst(land) : nullptr;
+
+		if(party)
+		    for(auto & bcr : party->toBattleCreatures())
+			defenders[id].add(BaseStat(bcr->attack(), bcr->ranger(), bcr->defense(), bcr->loyalty()), 0);
 	    }
 	}
+
+	for(auto & party : player.army)
+	    occupied[party.land()()] = party.count();
+    }
+
+    int AdventureBoard::attackValue(const Force & force, const Land & land) const
+    {
+	if(0 >= force.units)
+	    return 0;
+
+	const Force & def = defenders[land()];
+	const float chance = AI::battleChance(force.stat, force.units, def.stat, def.units);
+
+	return static_cast<int>(chance * AI::landWorth(land) - (1 - chance) * force.cost);
+    }
+
+    int AdventureBoard::exposure(const Land & land, int guard) const
+    {
+	// own land only: worth share not covered by guard
+	const int threat = maps.threat[land()];
+
+	if(isEnemy(land) || land.isTowerWinds() || threat <= guard)
+	    return 0;
+
+	return AI::landWorth(land) * (threat - guard) / threat;
+    }
+
+    int AdventureBoard::nextAttack(const Force & force, const Land & land) const
+    {
+	int res = 0;
+
+	for(auto & border : GameData::landInfo(land).borders)
+	    if(isEnemy(border) && ! border.isTowerWinds())
+		res = std::max(res, attackValue(force, border));
+
+	return res;
+    }
+
+    int AdventureBoard::moveValue(const AI::PartyMove & pm, const Land & land) const
+    {
+	const Force force = partyForce(pm);
+
+	// leave: guard of the source land falls
+	int res = exposure(pm.from, maps.guard[pm.from()]) - exposure(pm.from, maps.guard[pm.from()] - pm.guard);
+
+	if(isEnemy(land))
+	{
+	    const Force & planned = attackers[land()];
+
+	    if(planned.units + force.units > 3)
+		return std::numeric_limits<int>::min();
+
+	    Force joined = planned;
+	    joined.add(force);
+
+	    res += attackValue(joined, land) - attackValue(planned, land);
+	}
 	else
-	// set target land
 	{
-	    Lands lands = AI::findTargetsFor(party.toBaseStatSummary(), player.clan);
+	    if(occupied[land()] + force.units > 3)
+		return std::numeric_limits<int>::min();
 
-            std::random_device rd;
-            std::mt19937 mtg(rd());
-	    std::shuffle(lands.begin(), lands.end(), mtg);
+	    // guard threatened land, stage near the best target
+	    res += exposure(land, maps.guard[land()]) - exposure(land, maps.guard[land()] + pm.guard);
+	    res += (nextAttack(force, land) - nextAttack(force, pm.from)) / 2;
+	}
 
-	    if(lands.size())
-	    {
-                auto & tgtLand = lands.front();
+	return res;
+    }
+
+    void AdventureBoard::commit(const AI::PartyMove & pm, const Land & land)
+    {
+	maps.guard[pm.from()] -= pm.guard;
+
+	if(isEnemy(land))
+	    attackers[land()].add(partyForce(pm));
+	else
+	{
+	    maps.guard[land()] += pm.guard;
+	    occupied[land()] += pm.units.size();
+	}
+    }
+}
+
+std::vector<AI::PartyMove> AI::partyMoves(const RemotePlayer & player)
+{
+    const LandDistances & distances = landDistances();
+    std::vector<PartyMove> res;
 
-		// FIXME: sort to distance
-		DEBUG("avatar: " << player.avatar.toString() << ", " << "target: " << tgtLand.toString());
+    for(auto & party : player.army)
+    {
+	BattleCreatures bcrs = party.toBattleCreatures();
+	if(bcrs.empty())
+	    continue;
+
+	PartyMove pm;
+	pm.from = party.land();
+
+	int move = std::numeric_limits<int>::max();
+
+	for(auto & bcr : bcrs)
+	{
+	    pm.stat += BaseStat(bcr->attack(), bcr->ranger(), bcr->defense(), bcr->loyalty());
+	    pm.cost += GameData::creatureInfo(*bcr).cost;
+	    pm.guard += bcr->defense() + bcr->loyalty();
+	    pm.units.push_back(bcr->battleUnit());
+	    move = std::min(move, bcr->freeMovePoint());
+	}
+
+	for(auto & id : lands_all)
+	{
+	    const Land land(id);
+	    const int hops = distances(pm.from, land);
+
+	    if(land == pm.from || land.isTowerWinds() || hops > move)
+		continue;
+
+	    // the same path and rules as moveCreature
+	    Lands path = 1 < hops ? Lands::pathfind(pm.from, land) : Lands();
+	    if(path.empty()) path << land;
+
+	    if(std::all_of(bcrs.begin(), bcrs.end(), [&](const BattleCreature* bcr){ return player.army.canMoveCreature(*bcr, pm.from, path); }))
+		pm.lands << land;
+	}
+
+	if(pm.lands.size())
+	    res.push_back(pm);
+    }
+
+    return res;
+}
+
+bool AI::adventureMove(const RemotePlayer & player, ActionList & actions)
+{
+    std::vector<PartyMove> parties = partyMoves(player);
+    const int budget = adventureBudget(Settings::aiLevel());
+    GameSession & gs = GameData::session();
+
+    // ui game: tree search outside the server tick, moves taken by adventurePendingMoves
+    if(0 < budget && parties.size() && ! gs.gamers.isAllAI())
+    {
+	auto search = std::make_shared<AdventureSearch>(GameState::fromSession(gs), player.clan, parties);
+	gs.aiMoves = std::make_shared<PendingMoves>(player.avatar, search, std::async(std::launch::async, [=](){ return search->run(budget); }));
+	return false;
+    }
+
+    AdventureBoard board(player);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(AdventureFrameBudget);
+
+    // greedy: best party to land by expected value, until nothing beats staying or the frame budget is out
+    while(parties.size())
+    {
+	if(deadline < std::chrono::steady_clock::now())
+	{
+	    DEBUG("avatar: " << player.avatar.toString() << ", " << "frame budget out, parties stay: " << parties.size());
+	    break;
+	}
+
+	auto best = parties.end();
+	Land bestLand;
+	int bestValue = 0;
+
+	for(auto it = parties.begin(); it != parties.end(); ++it)
+	    for(auto & land : (*it).lands)
+	{
+	    int value = board.moveValue(*it, land);
+
+	    if(bestValue < value)
+	    {
+		best = it;
+		bestLand = land;
+		bestValue = value;
 	    }
 	}
+
+	if(best == parties.end())
+	    break;
+
+	DEBUG("avatar: " << player.avatar.toString() << ", " << "from: " << (*best).from.toString() << ", " <<
+		"to: " << bestLand.toString() << ", " << "value: " << bestValue);
+
+	board.commit(*best, bestLand);
+
+	for(auto & unit : (*best).units)
+	    GameData::client2Adventure(player.avatar, ClientUnitMoved(unit, bestLand), actions);
+
+	parties.erase(best);
     }
+
+    return true;
 }
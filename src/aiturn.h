@@ -27,18 +27,114 @@
 
 namespace AI
 {
-    bool        mahjongTurn(const Wind &, const Avatar &, const VecStones & trash,
-                            const WinRules & left, const WinRules & right, const WinRules & top,
-                            bool showGame, bool showKong, ActionList &);
+    /* opponent public info: hand size, open sets, own discards */
+    struct OpponentModel
+    {
+	Wind			wind;
+	int			concealed;
+	int			exposed;
+	bool			allowChao;
+	const RuneCounts*	discards;
+
+	OpponentModel() : concealed(0), exposed(0), allowChao(false), discards(nullptr) {}
+	OpponentModel(const LocalPlayer &, const Wind & discarder, const TileTracker &);
+    };
+
+    typedef std::vector<OpponentModel> OpponentModels;
+
+    /* stones not seen by one player: wall and other hands */
+    struct TileOdds
+    {
+	RuneCounts		unseen;
+	int			pool;
+
+	TileOdds(const GameStones & own, const TileTracker &);
+
+	float			holdAtLeast(const Stone &, int count, int hand) const;
+	float			danger(const Stone &, const OpponentModel &) const;
+    };
+
+    /* per land maps for one clan: built once per ai turn, shared by all candidates */
+    struct LandMaps
+    {
+	typedef std::array<int, Land::SiphonsChute + 1> LandValues;
+
+	LandValues		threat;   // enemy attack + ranger: party land and borders
+	LandValues		guard;    // own defense + loyalty: town and party
+	LandValues		frontier; // best enemy border land: town points
+
+	LandMaps(const Clan &);
+
+	int			need(const Land &) const;
+    };
+
+    /* summon or cast candidate, score: board gain minus point cost */
+    struct CastPlan
+    {
+	Creature		creature;
+	Spell			spell;
+	Land			land;
+	Avatar			target;
+	int			unit;
+	int			cost;
+	int			score;
+
+	CastPlan() : unit(0), cost(0), score(0) {}
+
+	bool			isValid(void) const { return creature.isValid() || spell.isValid(); }
+    };
+
+    /* move points between lands: copy of the lands map table, built once */
+    struct LandDistances
+    {
+	enum { Unreachable = 0xFF };
+
+	std::array<std::array<uint8_t, Land::SiphonsChute + 1>, Land::SiphonsChute + 1> hops;
+
+	LandDistances();
+
+	int			operator() (const Land &, const Land &) const;
+    };
+
+    const LandDistances &	landDistances(void);
+
+    /* rough win chance of the attack, units: side size with the town */
+    float			battleChance(const BaseStat & attackers, int units1, const BaseStat & defenders, int units2);
+
+    /* town points, power land: summon place */
+    int				landWorth(const Land &);
+
+    /* ai party and its legal destinations this turn */
+    struct PartyMove
+    {
+	Land			from;
+	BaseStat		stat;
+	int			cost;
+	int			guard;	// defense + loyalty
+	std::vector<int>	units;
+	Lands			lands;
+
+	PartyMove() : cost(0), guard(0) {}
+    };
+
+    std::vector<PartyMove>	partyMoves(const RemotePlayer &);
+
+    CastPlan    planSummon(const LocalPlayer &, const Creature &, const LandMaps &, int statPrice);
+    CastPlan    planCast(const LocalPlayer &, const Spell &, const LandMaps &, int statPrice);
+
+    bool        mahjongTurn(const Wind &, const Avatar &, bool showGame, bool showKong, ActionList &);
 
     bool        mahjongGameKongPungChao(const Wind & currentWind, const Wind & roundWind,
 			    const Stone & dropStone, WinResults &, ActionList &, bool sayOnly);
 
-    int         mahjongSelect(const GameStones &, const VecStones &, const WinRules &);
+    int         keepCost(const GameStones &, const Stone &, const TileTracker &, const TileOdds &, const OpponentModels &);
+    int         mahjongSelect(const GameStones &, const TileTracker &, const OpponentModels &);
+    OpponentModels opponentModels(const Wind & currentWind, const TileTracker &);
     void        mahjongOtherPass(const Wind &, ActionList &, const Wind &);
     void        mahjongSummonCast(const Avatar &, const Creatures &, const Spells &, ActionList &);
 
-    void        adventureMove(const RemotePlayer &, ActionList &);
+    // false: search started, moves pending
+    bool        adventureMove(const RemotePlayer &, ActionList &);
 }
 
 #endif
@@ -20,20 +20,125 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
-#include <random>
-#include <algorithm>
+#include <array>
+#include <cstdlib>
 
 #include "battle.h"
 
 namespace Battle
 {
-    int			calculateDamage(const BattleUnit & skill1, const BattleUnit & skill2, int bonus);
+    /* party slots for the whole battle: specials read once, bit mask of occupied slots */
+    struct Roster
+    {
+	std::array<BattleCreature*, 3> units;
+	std::array<unsigned long, 3> specials;
+	int			valid;
+
+	Roster(BattleParty*);
+
+	void			refresh(void);
+	int			select(const Specials &, bool filter) const;
+	int			random(int mask, std::mt19937 &) const;
+	int			bonus(int slot) const;
+	int			count(void) const;
+    };
+
+    int			calculateDamage(const BattleUnit & skill1, const BattleUnit & skill2, int bonus, std::mt19937 &);
     BattleStrike	applyRangerAttack(const BattleUnit & skill, BattleCreature & target);
-    BattleStrikes	rangersAttack(const BattleCreatures & rangers, BattleParty & enemy);
-    BattleStrikes	applyMeleeAttack(BattleUnit & skill1, BattleUnit & skill2, int bonus);
-    BattleStrikes	meleeAttack(BattleUnit & skill, BattleParty & enemy);
-    BattleStrikes	meleesAttack(BattleCreatures attackers, BattleParty & enemy);
-    BattleStrikes	doTargetStrike(BattleCreature & bcr, const BattleCreatures & party, BattleCreature & target);
+    void		rangersAttack(const Roster & rangers, int mask, const Roster & enemy, BattleStrikes &, std::mt19937 &);
+    void		applyMeleeAttack(BattleUnit & skill1, BattleUnit & skill2, int bonus, BattleStrikes &, std::mt19937 &);
+    void		meleeAttack(BattleUnit & skill, const Roster & enemy, BattleStrikes &, std::mt19937 &);
+    void		meleesAttack(const Roster & attackers, const Roster & enemy, BattleStrikes &, std::mt19937 &);
+    void		doTargetStrike(BattleUnit & bcr, int bonus, BattleUnit & target, BattleStrikes &, std::mt19937 &);
+}
+
+Battle::Roster::Roster(BattleParty* party) : valid(0)
+{
+    units.fill(nullptr);
+    specials.fill(0);
+
+    for(int it = 0; party && it < static_cast<int>(units.size()); ++it)
+    {
+	const BattleCreature* bcr = party->index(it);
+
+	if(bcr && bcr->isValid())
+	{
+	    units[it] = const_cast<BattleCreature*>(bcr);
+	    specials[it] = GameData::creatureInfo(*bcr).specials.to_ulong();
+	}
+    }
+
+    refresh();
+}
+
+void Battle::Roster::refresh(void)
+{
+    valid = 0;
+
+    // slots cleared by BattleParty::removeUnloyalty
+    for(int it = 0; it < static_cast<int>(units.size()); ++it)
+	if(units[it] && units[it]->isValid()) valid |= 1 << it;
+}
+
+int Battle::Roster::select(const Specials & specs, bool filter) const
+{
+    const unsigned long mask = specs.to_ulong();
+    int res = 0;
+
+    // same rules as BattleParty::toBattleCreatures(specials, filter)
+    for(int it = 0; it < static_cast<int>(units.size()); ++it)
+	if(valid & (1 << it))
+    {
+	bool push = false;
+
+	if(filter)
+	    push = mask ? specials[it] & mask : specials[it] == 0;
+	else
+	    push = mask ? specials[it] & ~mask : specials[it] != 0;
+
+	if(push) res |= 1 << it;
+    }
+
+    return res;
+}
+
+int Battle::Roster::random(int mask, std::mt19937 & rng) const
+{
+    int count = 0;
+
+    for(int it = 0; it < static_cast<int>(units.size()); ++it)
+	if(mask & (1 << it)) count++;
+
+    if(0 == count)
+	return -1;
+
+    int pos = std::uniform_int_distribution<int>(0, count - 1)(rng);
+
+    for(int it = 0; it < static_cast<int>(units.size()); ++it)
+	if((mask & (1 << it)) && 0 == pos--) return it;
+
+    return -1;
+}
+
+int Battle::Roster::bonus(int slot) const
+{
+    int res = 0;
+
+    // creatures behind the current one
+    for(int it = slot + 1; it < static_cast<int>(units.size()); ++it)
+	if(valid & (1 << it)) res++;
+
+    return res;
+}
+
+int Battle::Roster::count(void) const
+{
+    int res = 0;
+
+    for(int it = 0; it < static_cast<int>(units.size()); ++it)
+	if(valid & (1 << it)) res++;
+
+    return res;
 }
 
 BattleStrike Battle::applyRangerAttack(const BattleUnit & skill, BattleCreature & target)
@@ -55,27 +160,19 @@ BattleStrike Battle::applyRangerAttack(const BattleUnit & skill, BattleCreature
     return BattleStrike(skill, skill.ranger(), target, BattleStrike::Ranger);
 }
 
-BattleStrikes Battle::rangersAttack(const BattleCreatures & rangers, BattleParty & enemy)
+void Battle::rangersAttack(const Roster & rangers, int mask, const Roster & enemy, BattleStrikes & res, std::mt19937 & rng)
 {
-    BattleStrikes res;
+    const int targets = enemy.select(Specials() << Speciality::IgnoreMissiles, false);
 
-    std::random_device rd;
-    std::mt19937 mtg(rd());
-
-    for(auto & bcr : rangers)
+    for(int it = 0; it < static_cast<int>(rangers.units.size()); ++it)
+	if(mask & (1 << it))
     {
-	BattleCreatures bcrs = enemy.toBattleCreatures(Specials() << Speciality::IgnoreMissiles, false);
-
-        std::shuffle(bcrs.begin(), bcrs.end(), mtg);
-
-	auto tgt = bcrs.size() ? bcrs.front() : nullptr;
-	if(bcr && tgt) res << applyRangerAttack(*bcr, *tgt);
+	int slot = enemy.random(targets, rng);
+	if(0 <= slot) res << applyRangerAttack(*rangers.units[it], *enemy.units[slot]);
     }
-
-    return res;
 }
 
-int Battle::calculateDamage(const BattleUnit & skill1, const BattleUnit & skill2, int bonus)
+int Battle::calculateDamage(const BattleUnit & skill1, const BattleUnit & skill2, int bonus, std::mt19937 & rng)
 {
     int mighty_blow = 0;
 
@@ -83,7 +180,7 @@ int Battle::calculateDamage(const BattleUnit & skill1, const BattleUnit & skill2
     {
 	SpecialityMightyBlow blow;
 
-	if(blow.chance() > Tools::rand(1, 100))
+	if(blow.chance() > std::uniform_int_distribution<int>(1, 100)(rng))
 	{
 	    VERBOSE("Speciality: " << "Mighty Blow!");
 	    mighty_blow = blow.strength();
@@ -95,7 +192,7 @@ int Battle::calculateDamage(const BattleUnit & skill1, const BattleUnit & skill2
 
     if(damage <= 0)
     {
-	int rnd = Tools::rand(1, 100);
+	int rnd = std::uniform_int_distribution<int>(1, 100)(rng);
 
 	switch(std::abs(damage))
         {
@@ -117,11 +214,9 @@ int Battle::calculateDamage(const BattleUnit & skill1, const BattleUnit & skill2
     return damage;
 }
 
-BattleStrikes Battle::applyMeleeAttack(BattleUnit & skill1, BattleUnit & skill2, int bonus)
+void Battle::applyMeleeAttack(BattleUnit & skill1, BattleUnit & skill2, int bonus, BattleStrikes & res, std::mt19937 & rng)
 {
-    BattleStrikes res;
-
-    int damage = calculateDamage(skill1, skill2, bonus);
+    int damage = calculateDamage(skill1, skill2, bonus, rng);
     skill2.applyDamage(damage);
 
     DEBUG("attacker: " << skill1.name() << ", " << "do damage: " << damage << ", " << "bonus: " << bonus << ", " <<
@@ -144,86 +239,67 @@ BattleStrikes Battle::applyMeleeAttack(BattleUnit & skill1, BattleUnit & skill2,
 
 	res << BattleStrike(skill2, damage, skill1, BattleStrike::FireShield);
     }
-
-    return res;
 }
 
-BattleStrikes Battle::meleeAttack(BattleUnit & skill, BattleParty & enemy)
+void Battle::meleeAttack(BattleUnit & skill, const Roster & enemy, BattleStrikes & res, std::mt19937 & rng)
 {
-    BattleStrikes res;
-    BattleCreatures bcrs = enemy.toBattleCreatures();
-
-    std::random_device rd;
-    std::mt19937 mtg(rd());
-    std::shuffle(bcrs.begin(), bcrs.end(), mtg);
-
-    auto target = bcrs.size() ? bcrs.front() : nullptr;
+    int slot = enemy.random(enemy.valid, rng);
+    BattleCreature* target = 0 <= slot ? enemy.units[slot] : nullptr;
 
     if(target && target->isAlive() && skill.isAlive())
     {
-	res << applyMeleeAttack(skill, *target, 0);
+	applyMeleeAttack(skill, *target, 0, res, rng);
 
 	if(target->isAlive())
-	    res << applyMeleeAttack(*target, skill, 0);
+	    applyMeleeAttack(*target, skill, 0, res, rng);
     }
-
-    return res;
 }
 
-BattleStrikes Battle::doTargetStrike(BattleCreature & bcr, const BattleCreatures & party, BattleCreature & target)
+void Battle::doTargetStrike(BattleUnit & bcr, int bonus, BattleUnit & target, BattleStrikes & res, std::mt19937 & rng)
 {
-    BattleStrikes res;
-
-    auto it = std::find(party.begin(), party.end(), & bcr);
-
-    if(it != party.end())
-    {
-	// bonus: see comment below
-	int bonus = party.size() - std::distance(party.begin(), it) - 1;
-	res << applyMeleeAttack(bcr, target, bonus);
-    }
-
-    return res;
+    // bonus: see comment below
+    applyMeleeAttack(bcr, target, bonus, res, rng);
 }
 
-BattleStrikes Battle::meleesAttack(BattleCreatures attackers, BattleParty & enemy)
+void Battle::meleesAttack(const Roster & attackers, const Roster & enemy, BattleStrikes & res, std::mt19937 & rng)
 {
-    BattleStrikes res;
-    std::random_device rd;
-    std::mt19937 mtg(rd());
-
-    for(auto & bcr : attackers)
+    for(int it = 0; it < static_cast<int>(attackers.units.size()); ++it)
+	if(attackers.valid & (1 << it))
     {
-	BattleCreatures bcrs = enemy.toBattleCreatures();
-        std::shuffle(bcrs.begin(), bcrs.end(), mtg);
+	BattleCreature* bcr = attackers.units[it];
+	int slot = enemy.random(enemy.valid, rng);
 
-	auto tgt = bcrs.size() ? bcrs.front() : nullptr;
-	if(bcr && tgt)
+	if(0 <= slot)
 	{
+	    BattleCreature* tgt = enemy.units[slot];
+	    // target is first of the shuffled enemy party: all others behind it
+	    const int bonus1 = attackers.bonus(it);
+	    const int bonus2 = enemy.count() - 1;
+
 	    if(tgt->haveSpeciality(Speciality::FirstStrike))
 	    {
 		VERBOSE("Speciality: " << "First Strike!");
-		res << doTargetStrike(*tgt, bcrs, *bcr);
+		doTargetStrike(*tgt, bonus2, *bcr, res, rng);
 
 		if(bcr->isAlive())
-		    res << doTargetStrike(*bcr, attackers, *tgt);
+		    doTargetStrike(*bcr, bonus1, *tgt, res, rng);
 	    }
 	    else
 	    {
-		res << doTargetStrike(*bcr, attackers, *tgt);
+		doTargetStrike(*bcr, bonus1, *tgt, res, rng);
 
 		if(tgt->isAlive())
-		    res << doTargetStrike(*tgt, bcrs, *bcr);
+		    doTargetStrike(*tgt, bonus2, *bcr, res, rng);
 	    }
 	}
     }
-
-    return res;
 }
 
-BattleStrikes Battle::doAttackParty(BattleParty & attackers, BattleTown & town, BattleParty* defenders)
+BattleStrikes Battle::doAttackParty(BattleParty & attackers, BattleTown & town, BattleParty* defenders, std::mt19937 & rng)
 {
     BattleStrikes res;
+    Roster roster1(& attackers);
+    Roster roster2(defenders);
 
     /*
 	The first round of combat is ranged combat.
@@ -238,30 +314,25 @@ BattleStrikes Battle::doAttackParty(BattleParty & attackers, BattleTown & town,
 
     if(town.isRanger())
     {
-	BattleCreatures bcrs = attackers.toBattleCreatures(Specials() << Speciality::IgnoreMissiles, false);
-
-        std::random_device rd;
-        std::mt19937 mtg(rd());
-        std::shuffle(bcrs.begin(), bcrs.end(), mtg);
+	int slot = roster1.random(roster1.select(Specials() << Speciality::IgnoreMissiles, false), rng);
 
-	auto target = bcrs.size() ? bcrs.front() : nullptr;
-
-	if(target)
+	if(0 <= slot)
 	{
-	    res << applyRangerAttack(town, *target);
+	    res << applyRangerAttack(town, *roster1.units[slot]);
 	    attackers.removeUnloyalty();
+	    roster1.refresh();
 	}
     }
 
     if(defenders)
     {
-	BattleCreatures bcrs1 = attackers.toBattleCreatures(Specials() << Speciality::RangerAttack, true);
-	res << rangersAttack(bcrs1, *defenders);
+	rangersAttack(roster1, roster1.select(Specials() << Speciality::RangerAttack, true), roster2, res, rng);
 	defenders->removeUnloyalty();
+	roster2.refresh();
 
-	BattleCreatures bcrs2 = defenders->toBattleCreatures(Specials() << Speciality::RangerAttack, true);
-	res << rangersAttack(bcrs2, attackers);
+	rangersAttack(roster2, roster2.select(Specials() << Speciality::RangerAttack, true), roster1, res, rng);
 	attackers.removeUnloyalty();
+	roster1.refresh();
     }
 
     /*
@@ -283,20 +354,432 @@ BattleStrikes Battle::doAttackParty(BattleParty & attackers, BattleTown & town,
                 3                                6
                 n                             1/(n+1)
 */
-    while(attackers.count() && town.isAlive())
+    while(roster1.valid && town.isAlive())
     {
-	if(defenders && defenders->count())
+	if(roster2.valid)
 	{
-	    res << meleesAttack(defenders->toBattleCreatures(), attackers);
+	    meleesAttack(roster2, roster1, res, rng);
 	    attackers.removeUnloyalty();
 	    defenders->removeUnloyalty();
+	    roster2.refresh();
 	}
 	else
 	{
-	    res << meleeAttack(town, attackers);
+	    meleeAttack(town, roster1, res, rng);
 	    attackers.removeUnloyalty();
 	}
+
+	roster1.refresh();
+    }
+
+    return res;
+}
+
+Battle::Combat::Combat(BattleParty* party1, BattleParty* party2, const BattleTown & bt, unsigned int seed)
+    : attackers(party1), defenders(party2), town(bt), random(seed)
+{
+}
+
+void Battle::Combat::resolve(void)
+{
+    strikes = doAttackParty(*attackers, town, defenders, random);
+}
+
+void Battle::resolveCombats(std::vector<Combat> & combats)
+{
+    // a clan step has six parties at most: a pool task hand off (~5 us) costs more than a battle (~1 us)
+    for(auto & combat : combats)
+	combat.resolve();
+}
+
+Battle::Matchup::Unit::Unit(const BattleUnit & bu) : attack(bu.attack()), ranger(bu.ranger()), defense(bu.defense()), loyalty(bu.loyalty()),
+    valid(bu.isValid()), mightyBlow(bu.haveSpeciality(Speciality::MightyBlow)), firstStrike(bu.haveSpeciality(Speciality::FirstStrike)),
+    fireShield(bu.haveSpeciality(Speciality::FireShield)), missileTarget(false),
+    rangerAttack(bu.haveSpeciality(Speciality::RangerAttack)), forceShield(false)
+{
+}
+
+Battle::Matchup::Matchup(const BattleParty & attackers, const BattleTown & bt, const BattleParty* defenders)
+    : town(bt), withDefenders(defenders != nullptr), blowChance(SpecialityMightyBlow().chance()), blowStrength(SpecialityMightyBlow().strength())
+{
+    const BattleParty* parties[] = { & attackers, defenders };
+    const unsigned long ignore = (Specials() << Speciality::IgnoreMissiles).to_ulong();
+
+    for(int side = 0; side < 2; ++side)
+	for(int it = 0; parties[side] && it < static_cast<int>(sides[side].size()); ++it)
+    {
+	const BattleCreature* bcr = parties[side]->index(it);
+
+	if(bcr && bcr->isValid())
+	{
+	    sides[side][it] = Unit(*bcr);
+	    sides[side][it].forceShield = bcr->isAffectedSpell(Spell::ForceShield);
+	    // same rule as rangersAttack: creatures without specials are not targeted
+	    sides[side][it].missileTarget = GameData::creatureInfo(*bcr).specials.to_ulong() & ~ignore;
+	}
+    }
+}
+
+/* lanes kernel: one vector per stat, selects instead of branches, compiled for avx2 and sse2 */
+#if defined(__GNUC__) && ! defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+#define BATTLE_LANES_TARGETS __attribute__((target_clones("avx2", "default"), flatten))
+#else
+#define BATTLE_LANES_TARGETS
+#endif
+
+namespace
+{
+    enum { Lanes = Battle::Matchup::Lanes };
+
+    /* gnu vector in a struct: aggregates are passed in memory, no avx abi change between clones;
+       scalar fallback with gnu vector semantics, compare gives -1 or 0 */
+    struct LaneInt
+    {
+#if defined(__GNUC__)
+	typedef int32_t		vector_t __attribute__((vector_size(Lanes * sizeof(int32_t))));
+	vector_t		val;
+#else
+	int32_t			val[Lanes];
+#endif
+
+	int32_t &		operator[](int ln) { return val[ln]; }
+	const int32_t &		operator[](int ln) const { return val[ln]; }
+    };
+
+#if defined(__GNUC__)
+#define LANE_OPERATOR(op, expr) \
+    inline LaneInt operator op(const LaneInt & a, const LaneInt & b) { LaneInt res; res.val = a.val op b.val; return res; } \
+    inline LaneInt operator op(const LaneInt & a, int32_t v) { LaneInt res; res.val = a.val op v; return res; }
+#else
+#define LANE_OPERATOR(op, expr) \
+    inline LaneInt operator op(const LaneInt & a, const LaneInt & b) { LaneInt res; for(int ln = 0; ln < Lanes; ++ln) res[ln] = (expr); return res; } \
+    inline LaneInt operator op(const LaneInt & a, int32_t v) { LaneInt b; for(int ln = 0; ln < Lanes; ++ln) b[ln] = v; return a op b; }
+#endif
+
+    LANE_OPERATOR(+, a[ln] + b[ln])
+    LANE_OPERATOR(-, a[ln] - b[ln])
+    LANE_OPERATOR(*, a[ln] * b[ln])
+    LANE_OPERATOR(&, a[ln] & b[ln])
+    LANE_OPERATOR(|, a[ln] | b[ln])
+    LANE_OPERATOR(^, a[ln] ^ b[ln])
+    LANE_OPERATOR(<<, a[ln] << b[ln])
+    LANE_OPERATOR(>>, a[ln] >> b[ln])
+    LANE_OPERATOR(==, a[ln] == b[ln] ? -1 : 0)
+    LANE_OPERATOR(<, a[ln] < b[ln] ? -1 : 0)
+    LANE_OPERATOR(>, a[ln] > b[ln] ? -1 : 0)
+    LANE_OPERATOR(<=, a[ln] <= b[ln] ? -1 : 0)
+    LANE_OPERATOR(>=, a[ln] >= b[ln] ? -1 : 0)
+#undef LANE_OPERATOR
+
+    inline LaneInt operator~(const LaneInt & a) { return a ^ -1; }
+    inline LaneInt operator-(const LaneInt & a) { return a * -1; }
+    inline LaneInt & operator-=(LaneInt & a, const LaneInt & b) { a = a - b; return a; }
+    inline LaneInt & operator&=(LaneInt & a, const LaneInt & b) { a = a & b; return a; }
+
+    inline LaneInt splat(int32_t val)
+    {
+	LaneInt res;
+	for(int ln = 0; ln < Lanes; ++ln) res[ln] = val;
+	return res;
+    }
+
+    // mask lanes from first, others from second
+    inline LaneInt select(const LaneInt & mask, const LaneInt & first, const LaneInt & second)
+    {
+	return (first & mask) | (second & ~mask);
+    }
+
+    inline LaneInt slotValue(const LaneInt* values, const LaneInt & slot)
+    {
+	return select(slot == 0, values[0], select(slot == 1, values[1], values[2]));
+    }
+
+    inline bool anyLane(const LaneInt & mask)
+    {
+	int32_t res = 0;
+	for(int ln = 0; ln < Lanes; ++ln) res |= mask[ln];
+	return res;
+    }
+
+    // xorshift32 by lane, logical shift: arithmetic shift and mask
+    inline LaneInt laneRandom(LaneInt & state)
+    {
+	state = state ^ (state << 13);
+	state = state ^ ((state >> 17) & 0x7FFF);
+	state = state ^ (state << 5);
+	return state;
+    }
+
+    // uniform [0, range), 16 high bits: 32 bit multiply only
+    inline LaneInt laneRange(LaneInt & state, const LaneInt & range)
+    {
+	return (((laneRandom(state) >> 16) & 0xFFFF) * range) >> 16;
+    }
+
+    // Roster::random: slot of allowed units (masks), -1 for none
+    inline LaneInt laneTarget(const LaneInt & allow0, const LaneInt & allow1, const LaneInt & allow2, LaneInt & state)
+    {
+	const LaneInt count0 = allow0 & 1;
+	const LaneInt count = count0 + (allow1 & 1) + (allow2 & 1);
+	const LaneInt pos = laneRange(state, count);
+	const LaneInt slot = select(allow0 & (pos == 0), splat(0), select(allow1 & (pos == count0), splat(1), splat(2)));
+
+	return select(count == 0, splat(-1), slot);
+    }
+
+    // calculateDamage: blow is mighty blow chance or 0, miss table as threshold of roll
+    inline LaneInt laneDamage(const LaneInt & attack, const LaneInt & defense, const LaneInt & blow, int32_t strength, LaneInt & state)
+    {
+	const LaneInt roll1 = laneRange(state, splat(100)) + 1;
+	const LaneInt roll2 = laneRange(state, splat(100)) + 1;
+	const LaneInt damage = attack + ((roll1 < blow) & strength) - defense;
+	const LaneInt miss = -damage;
+	const LaneInt chance = select(miss == 0, splat(50), select(miss == 1, splat(25), select(miss == 2, splat(12),
+				select(miss == 3, splat(6), select(miss == 4, splat(3), splat(1))))));
+
+	return select(damage > 0, damage, (roll2 <= chance) & 1);
+    }
+
+    inline uint32_t laneSeed(uint32_t seed, int index)
+    {
+	uint32_t res = seed + 0x9E3779B9u * static_cast<uint32_t>(index + 1);
+	res = (res ^ (res >> 16)) * 0x85EBCA6Bu;
+	res = (res ^ (res >> 13)) * 0xC2B2AE35u;
+	res ^= res >> 16;
+	return res ? res : 1;
+    }
+
+    /* doAttackParty rules for Lanes battles: side 0 attackers, side 1 defenders */
+    struct LaneBattle
+    {
+	LaneInt			loyalty[2][3];
+	LaneInt			valid[2][3]; /* masks */
+	LaneInt			town;
+	LaneInt			random;
+
+	/* per slot stats, same in all lanes */
+	LaneInt			attack[2][3];
+	LaneInt			ranger[2][3];
+	LaneInt			defense[2][3];
+	LaneInt			blow[2][3];
+	LaneInt			first[2][3];
+	LaneInt			fire[2][3];
+	LaneInt			shield[2][3];
+	LaneInt			open[2][3]; /* ranged target, masks */
+
+	const Battle::Matchup &	match;
+
+	LaneBattle(const Battle::Matchup &, const uint32_t* seeds);
+
+	void			refresh(int side);
+	LaneInt			bonus(int side, const LaneInt & slot) const;
+	LaneInt			count(int side) const;
+	void			strike(const LaneInt & mask, int side1, const LaneInt & slot1, const LaneInt & bonus1, int side2, const LaneInt & slot2);
+	void			rangedTown(void);
+	void			ranged(int side, int enemy);
+	void			melee(int side, int slot, const LaneInt & phase);
+	void			meleeTown(const LaneInt & phase);
+	int			play(void);
+    };
+
+    LaneBattle::LaneBattle(const Battle::Matchup & mt, const uint32_t* seeds) : match(mt)
+    {
+	for(int side = 0; side < 2; ++side)
+	    for(int slot = 0; slot < 3; ++slot)
+	{
+	    const Battle::Matchup::Unit & unit = mt.sides[side][slot];
+
+	    loyalty[side][slot] = splat(unit.loyalty);
+	    valid[side][slot] = splat(unit.valid && 0 < unit.loyalty ? -1 : 0);
+	    attack[side][slot] = splat(unit.attack);
+	    ranger[side][slot] = splat(unit.ranger);
+	    defense[side][slot] = splat(unit.defense);
+	    blow[side][slot] = splat(unit.mightyBlow ? mt.blowChance : 0);
+	    first[side][slot] = splat(unit.firstStrike ? -1 : 0);
+	    fire[side][slot] = splat(unit.fireShield ? 1 : 0);
+	    shield[side][slot] = splat(unit.forceShield ? 1 : 0);
+	    open[side][slot] = splat(unit.missileTarget ? -1 : 0);
+	}
+
+	town = splat(mt.town.loyalty);
+
+	for(int ln = 0; ln < Lanes; ++ln)
+	    random[ln] = static_cast<int32_t>(seeds[ln]);
+    }
+
+    // BattleParty::removeUnloyalty + Roster::refresh
+    void LaneBattle::refresh(int side)
+    {
+	for(int slot = 0; slot < 3; ++slot)
+	    valid[side][slot] &= loyalty[side][slot] > 0;
+    }
+
+    // Roster::bonus: creatures behind the slot
+    LaneInt LaneBattle::bonus(int side, const LaneInt & slot) const
+    {
+	const LaneInt behind2 = valid[side][2] & 1;
+	const LaneInt behind1 = (valid[side][1] & 1) + behind2;
+
+	return select(slot == 0, behind1, select(slot == 1, behind2, splat(0)));
+    }
+
+    // Roster::count: valid creatures of side
+    LaneInt LaneBattle::count(int side) const
+    {
+	return (valid[side][0] & 1) + (valid[side][1] & 1) + (valid[side][2] & 1);
+    }
+
+    // applyMeleeAttack: creature (side1, slot1) hits creature (side2, slot2), random used by all lanes
+    void LaneBattle::strike(const LaneInt & mask, int side1, const LaneInt & slot1, const LaneInt & bonus1, int side2, const LaneInt & slot2)
+    {
+	const LaneInt damage = laneDamage(slotValue(attack[side1], slot1) + bonus1, slotValue(defense[side2], slot2),
+					slotValue(blow[side1], slot1), match.blowStrength, random);
+	const LaneInt back = slotValue(fire[side2], slot2);
+
+	for(int slot = 0; slot < 3; ++slot)
+	{
+	    loyalty[side2][slot] -= damage & mask & (slot2 == slot);
+	    loyalty[side1][slot] -= back & mask & (slot1 == slot);
+	}
+    }
+
+    void LaneBattle::rangedTown(void)
+    {
+	const LaneInt target = laneTarget(valid[0][0] & open[0][0], valid[0][1] & open[0][1], valid[0][2] & open[0][2], random);
+	const LaneInt damage = splat(match.town.ranger) - slotValue(shield[0], target);
+
+	for(int slot = 0; slot < 3; ++slot)
+	    loyalty[0][slot] -= damage & (damage > 0) & (target == slot);
+    }
+
+    // rangersAttack: targets are fixed by valid slots before the volley
+    void LaneBattle::ranged(int side, int enemy)
+    {
+	for(int slot = 0; slot < 3; ++slot)
+	    if(match.sides[side][slot].rangerAttack)
+	{
+	    const LaneInt target = laneTarget(valid[enemy][0] & open[enemy][0], valid[enemy][1] & open[enemy][1], valid[enemy][2] & open[enemy][2], random);
+	    const LaneInt damage = ranger[side][slot] - slotValue(shield[enemy], target);
+	    const LaneInt mask = valid[side][slot] & (damage > 0);
+
+	    for(int it = 0; it < 3; ++it)
+		loyalty[enemy][it] -= damage & mask & (target == it);
+	}
+    }
+
+    // meleesAttack: one slot of side against side 0
+    void LaneBattle::melee(int side, int slot, const LaneInt & phase)
+    {
+	const LaneInt own = splat(slot);
+	const LaneInt target = laneTarget(valid[0][0], valid[0][1], valid[0][2], random);
+	const LaneInt mask = phase & valid[side][slot] & (target >= 0);
+	const LaneInt firstStrike = slotValue(first[0], target);
+	const LaneInt bonus1 = bonus(side, own);
+	const LaneInt bonus2 = count(0) - 1;
+
+	// first strike: target hits first, the other hits back if alive
+	strike(mask & firstStrike, 0, target, bonus2, side, own);
+	strike(mask & ~firstStrike, side, own, bonus1, 0, target);
+
+	const LaneInt alive1 = loyalty[side][slot] > 0;
+	const LaneInt alive2 = slotValue(loyalty[0], target) > 0;
+
+	strike(mask & firstStrike & alive1, side, own, bonus1, 0, target);
+	strike(mask & ~firstStrike & alive2, 0, target, bonus2, side, own);
+    }
+
+    // meleeAttack: town and attacker exchange blows without bonus
+    void LaneBattle::meleeTown(const LaneInt & phase)
+    {
+	const LaneInt target = laneTarget(valid[0][0], valid[0][1], valid[0][2], random);
+	const LaneInt loyalty1 = slotValue(loyalty[0], target);
+	const LaneInt mask = phase & (target >= 0) & (loyalty1 > 0) & (town > 0);
+
+	const LaneInt damage1 = laneDamage(splat(match.town.attack), slotValue(defense[0], target), splat(0), 0, random);
+	const LaneInt damage2 = laneDamage(slotValue(attack[0], target), splat(match.town.defense), slotValue(blow[0], target), match.blowStrength, random);
+
+	for(int slot = 0; slot < 3; ++slot)
+	    loyalty[0][slot] -= damage1 & mask & (target == slot);
+
+	town -= damage2 & mask & (damage1 < loyalty1);
+    }
+
+    // bit mask of lanes with captured town
+    int LaneBattle::play(void)
+    {
+	if(match.town.ranger > 0)
+	{
+	    rangedTown();
+	    refresh(0);
+	}
+
+	if(match.withDefenders)
+	{
+	    ranged(0, 1);
+	    refresh(1);
+
+	    ranged(1, 0);
+	    refresh(0);
+	}
+
+	while(true)
+	{
+	    const LaneInt attackers = (valid[0][0] | valid[0][1] | valid[0][2]) & (town > 0);
+	    const LaneInt defenders = valid[1][0] | valid[1][1] | valid[1][2];
+
+	    // every lane finished: battles of lanes are independent
+	    if(! anyLane(attackers))
+		break;
+
+	    if(anyLane(attackers & defenders))
+		for(int slot = 0; slot < 3; ++slot)
+		    melee(1, slot, attackers & defenders);
+
+	    if(anyLane(attackers & ~defenders))
+		meleeTown(attackers & ~defenders);
+
+	    refresh(0);
+	    refresh(1);
+	}
+
+	int res = 0;
+
+	for(int ln = 0; ln < Lanes; ++ln)
+	    if(0 >= town[ln]) res |= 1 << ln;
+
+	return res;
+    }
+
+    BATTLE_LANES_TARGETS
+    int playLanes(const Battle::Matchup & match, const uint32_t* seeds)
+    {
+	LaneBattle lanes(match, seeds);
+	return lanes.play();
+    }
+}
+
+int Battle::Matchup::simulate(int battles, uint32_t seed) const
+{
+    int res = 0;
+
+    for(int base = 0; base < battles; base += Lanes)
+    {
+	std::array<uint32_t, Lanes> seeds;
+
+	for(int ln = 0; ln < Lanes; ++ln)
+	    seeds[ln] = laneSeed(seed, base + ln);
+
+	const int wins = playLanes(*this, seeds.data());
+
+	// tail lanes of the last group are not counted
+	for(int ln = 0; ln < Lanes && base + ln < battles; ++ln)
+	    if(wins & (1 << ln)) res++;
     }
 
     return res;
 }
+
+float Battle::Matchup::winChance(int battles, uint32_t seed) const
+{
+    return 0 < battles ? simulate(battles, seed) / static_cast<float>(battles) : 0;
+}
@@ -23,11 +23,71 @@
 #ifndef _RWNA_BATTLE_
 #define _RWNA_BATTLE_
 
+#include <array>
+#include <random>
+#include <vector>
+#include <cstdint>
+
 #include "gametheme.h"
 
 namespace Battle
 {
-    BattleStrikes       doAttackParty(BattleParty & attackers, BattleTown & town, BattleParty* defenders);
+    BattleStrikes       doAttackParty(BattleParty & attackers, BattleTown & town, BattleParty* defenders, std::mt19937 &);
+
+    /* one land battle of the turn: parties changed in place, own random stream */
+    struct Combat
+    {
+	BattleParty*		attackers;
+	BattleParty*		defenders;
+	BattleTown		town;
+	BattleStrikes		strikes;
+	std::mt19937		random;
+
+	Combat(BattleParty* attackers, BattleParty* defenders, const BattleTown &, unsigned int seed);
+
+	void			resolve(void);
+    };
+
+    /* combats of one clan step, in army order on the calling thread */
+    void                resolveCombats(std::vector<Combat> &);
+
+    /* one battle replayed many times: stats read once, battles played side by side in lanes */
+    struct Matchup
+    {
+	enum { Lanes = 8 };
+
+	/* battle stats of one slot, fixed for the whole battle except loyalty */
+	struct Unit
+	{
+	    int			attack;
+	    int			ranger;
+	    int			defense;
+	    int			loyalty;
+	    bool		valid;
+	    bool		mightyBlow;
+	    bool		firstStrike;
+	    bool		fireShield;
+	    bool		missileTarget; /* Roster::select(IgnoreMissiles, false) */
+	    bool		rangerAttack;
+	    bool		forceShield;
+
+	    Unit() : attack(0), ranger(0), defense(0), loyalty(0), valid(false), mightyBlow(false), firstStrike(false),
+		fireShield(false), missileTarget(false), rangerAttack(false), forceShield(false) {}
+	    Unit(const BattleUnit &);
+	};
+
+	std::array<std::array<Unit, 3>, 2> sides; /* attackers, defenders */
+	Unit			town;
+	bool			withDefenders;
+	int			blowChance;
+	int			blowStrength;
+
+	Matchup(const BattleParty & attackers, const BattleTown &, const BattleParty* defenders);
+
+	/* town captured count, same seed: same result on any cpu */
+	int			simulate(int battles, uint32_t seed) const;
+	float			winChance(int battles, uint32_t seed) const;
+    };
 }
 
 #endif
@@ -0,0 +1,857 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include <cstring>
+#include <algorithm>
+
+#include "gamedata.h"
+#include "catalog.h"
+
+namespace
+{
+    const char catalogMagic[4] = { 'R', 'W', 'G', 'C' };
+
+    /* records: 32 bit fields only, strings: offset in string table, lists: offset and count in id table */
+    struct StoneRecord
+    {
+	int32_t			id;
+	uint32_t		name;
+	uint32_t		large;
+	uint32_t		medium;
+	uint32_t		small;
+    };
+
+    struct WindRecord
+    {
+	int32_t			id;
+	uint32_t		name;
+	uint32_t		image;
+    };
+
+    struct ClanRecord
+    {
+	int32_t			id;
+	uint32_t		name;
+	uint32_t		image;
+	uint32_t		flag1;
+	uint32_t		flag2;
+	uint32_t		town;
+	uint32_t		button;
+	uint32_t		townflag1;
+	uint32_t		townflag2;
+    };
+
+    struct CreatureRecord
+    {
+	int32_t			id;
+	int32_t			stat[5]; /* attack, ranger, defense, loyalty, move */
+	int32_t			cost;
+	uint32_t		specials;
+	uint32_t		unique;
+	uint32_t		fly;
+	uint32_t		name;
+	uint32_t		image1;
+	uint32_t		image2;
+	uint32_t		description;
+	uint32_t		sound1;
+	uint32_t		stones[2];
+    };
+
+    struct SpellRecord
+    {
+	int32_t			id;
+	int32_t			target;
+	int32_t			effect[4];
+	int32_t			cost;
+	int32_t			extval;
+	uint32_t		persistent;
+	uint32_t		name;
+	uint32_t		image;
+	uint32_t		description;
+	uint32_t		sound;
+	uint32_t		stones[2];
+    };
+
+    /* specials and abilities */
+    struct NoteRecord
+    {
+	int32_t			id;
+	uint32_t		name;
+	uint32_t		description;
+    };
+
+    struct AvatarRecord
+    {
+	int32_t			id;
+	int32_t			ability;
+	uint32_t		name;
+	uint32_t		dignity;
+	uint32_t		description;
+	uint32_t		portrait;
+	uint32_t		image;
+	uint32_t		clans[2];
+	uint32_t		spells[2];
+	uint32_t		creatures[2];
+    };
+
+    struct LandRecord
+    {
+	int32_t			id;
+	int32_t			clan;
+	int32_t			stat[5]; /* attack, ranger, defense, loyalty, point */
+	uint32_t		power;
+	int32_t			center[2];
+	int32_t			area[4];
+	int32_t			iconrt[4];
+	uint32_t		name;
+	uint32_t		borders[2];
+	uint32_t		points[2]; /* offset and count of pairs in point table */
+    };
+
+    // json loader layout: index by id, nul reserve; record decoded in place
+    template<typename T, typename Id>
+    T* placeInfo(std::vector<T> & v, const Id & id)
+    {
+	const int index = id.index();
+
+	if(0 > index || index >= static_cast<int>(v.size()))
+	{
+	    ERROR("index out of range: " << index);
+	    return nullptr;
+	}
+
+	v[index].id = id;
+	return & v[index];
+    }
+
+    void putRect(const Rect & rt, int32_t* res)
+    {
+	res[0] = rt.x;
+	res[1] = rt.y;
+	res[2] = rt.w;
+	res[3] = rt.h;
+    }
+}
+
+Catalog::Writer::Writer()
+{
+    // offset 0: empty string
+    strings.push_back(0);
+    counts.fill(0);
+    strides.fill(0);
+}
+
+uint32_t Catalog::Writer::string(const std::string & str)
+{
+    if(str.empty())
+	return 0;
+
+    auto it = offsets.find(str);
+    if(it != offsets.end())
+	return (*it).second;
+
+    const uint32_t res = strings.size();
+    strings.insert(strings.end(), str.begin(), str.end());
+    strings.push_back(0);
+
+    offsets.emplace(str, res);
+    return res;
+}
+
+template<typename Iter>
+void Catalog::Writer::idList(Iter it1, Iter it2, uint32_t* res)
+{
+    res[0] = ids.size();
+
+    for(; it1 != it2; ++it1)
+	ids.push_back((*it1)());
+
+    res[1] = ids.size() - res[0];
+}
+
+template<typename T>
+void Catalog::Writer::record(const section_t & section, const T & rec)
+{
+    auto & bytes = sections[section];
+    const uint8_t* ptr = reinterpret_cast<const uint8_t*>(& rec);
+
+    bytes.insert(bytes.end(), ptr, ptr + sizeof(T));
+    counts[section] += 1;
+    strides[section] = sizeof(T);
+}
+
+void Catalog::Writer::add(const std::vector<StoneInfo> & v)
+{
+    for(auto & info : v)
+	if(info.id.isValid())
+    {
+	StoneRecord rec;
+	std::memset(& rec, 0, sizeof(rec));
+
+	rec.id = info.id();
+	rec.name = string(info.name);
+	rec.large = string(info.large);
+	rec.medium = string(info.medium);
+	rec.small = string(info.small);
+
+	record(Stones, rec);
+    }
+}
+
+void Catalog::Writer::add(const std::vector<WindInfo> & v)
+{
+    for(auto & info : v)
+	if(info.id.isValid())
+    {
+	WindRecord rec;
+	std::memset(& rec, 0, sizeof(rec));
+
+	rec.id = info.id();
+	rec.name = string(info.name);
+	rec.image = string(info.image);
+
+	record(Winds, rec);
+    }
+}
+
+void Catalog::Writer::add(const std::vector<ClanInfo> & v)
+{
+    for(auto & info : v)
+	if(info.id.isValid())
+    {
+	ClanRecord rec;
+	std::memset(& rec, 0, sizeof(rec));
+
+	rec.id = info.id();
+	rec.name = string(info.name);
+	rec.image = string(info.image);
+	rec.flag1 = string(info.flag1);
+	rec.flag2 = string(info.flag2);
+	rec.town = string(info.town);
+	rec.button = string(info.button);
+	rec.townflag1 = string(info.townflag1);
+	rec.townflag2 = string(info.townflag2);
+
+	record(Clans, rec);
+    }
+}
+
+void Catalog::Writer::add(const std::vector<CreatureInfo> & v)
+{
+    for(auto & info : v)
+	if(info.id.isValid())
+    {
+	CreatureRecord rec;
+	std::memset(& rec, 0, sizeof(rec));
+
+	rec.id = info.id();
+	rec.stat[0] = info.stat.attack;
+	rec.stat[1] = info.stat.ranger;
+	rec.stat[2] = info.stat.defense;
+	rec.stat[3] = info.stat.loyalty;
+	rec.stat[4] = info.stat.move;
+	rec.cost = info.cost;
+	rec.specials = info.specials.to_ulong();
+	rec.unique = info.unique;
+	rec.fly = info.fly;
+	rec.name = string(info.name);
+	rec.image1 = string(info.image1);
+	rec.image2 = string(info.image2);
+	rec.description = string(info.description);
+	rec.sound1 = string(info.sound1);
+	idList(info.stones.begin(), info.stones.end(), rec.stones);
+
+	record(Creatures, rec);
+    }
+}
+
+void Catalog::Writer::add(const std::vector<SpellInfo> & v)
+{
+    for(auto & info : v)
+	if(info.id.isValid())
+    {
+	SpellRecord rec;
+	std::memset(& rec, 0, sizeof(rec));
+
+	rec.id = info.id();
+	rec.target = info.target();
+	rec.effect[0] = info.effect.attack;
+	rec.effect[1] = info.effect.ranger;
+	rec.effect[2] = info.effect.defense;
+	rec.effect[3] = info.effect.loyalty;
+	rec.cost = info.cost;
+	rec.extval = info.extval;
+	rec.persistent = info.persistent;
+	rec.name = string(info.name);
+	rec.image = string(info.image);
+	rec.description = string(info.description);
+	rec.sound = string(info.sound);
+	idList(info.stones.begin(), info.stones.end(), rec.stones);
+
+	record(Spells, rec);
+    }
+}
+
+void Catalog::Writer::add(const std::vector<SpecialityInfo> & v)
+{
+    for(auto & info : v)
+	if(info.id.isValid())
+    {
+	NoteRecord rec;
+	std::memset(& rec, 0, sizeof(rec));
+
+	rec.id = info.id();
+	rec.name = string(info.name);
+	rec.description = string(info.description);
+
+	record(Specials, rec);
+    }
+}
+
+void Catalog::Writer::add(const std::vector<AbilityInfo> & v)
+{
+    for(auto & info : v)
+	if(info.id.isValid())
+    {
+	NoteRecord rec;
+	std::memset(& rec, 0, sizeof(rec));
+
+	rec.id = info.id();
+	rec.name = string(info.name);
+	rec.description = string(info.description);
+
+	record(Abilities, rec);
+    }
+}
+
+void Catalog::Writer::add(const std::vector<AvatarInfo> & v)
+{
+    for(auto & info : v)
+	if(info.id.isValid())
+    {
+	AvatarRecord rec;
+	std::memset(& rec, 0, sizeof(rec));
+
+	rec.id = info.id();
+	rec.ability = info.ability();
+	rec.name = string(info.name);
+	rec.dignity = string(info.dignity);
+	rec.description = string(info.description);
+	rec.portrait = string(info.portrait);
+	rec.image = string(info.image);
+	idList(info.clans.begin(), info.clans.end(), rec.clans);
+	idList(info.spells.begin(), info.spells.end(), rec.spells);
+	idList(info.creatures.begin(), info.creatures.end(), rec.creatures);
+
+	record(Avatars, rec);
+    }
+}
+
+void Catalog::Writer::add(const std::vector<LandInfo> & v)
+{
+    for(auto & info : v)
+	if(info.id.isValid())
+    {
+	LandRecord rec;
+	std::memset(& rec, 0, sizeof(rec));
+
+	rec.id = info.id();
+	rec.clan = info.clan();
+	rec.stat[0] = info.stat.attack;
+	rec.stat[1] = info.stat.ranger;
+	rec.stat[2] = info.stat.defense;
+	rec.stat[3] = info.stat.loyalty;
+	rec.stat[4] = info.stat.point;
+	rec.power = info.stat.power;
+	rec.center[0] = info.center.x;
+	rec.center[1] = info.center.y;
+	putRect(info.area, rec.area);
+	putRect(info.iconrt, rec.iconrt);
+	rec.name = string(info.name);
+	idList(info.borders.begin(), info.borders.end(), rec.borders);
+
+	rec.points[0] = points.size() / 2;
+	rec.points[1] = info.points.size();
+
+	for(auto & pt : info.points)
+	{
+	    points.push_back(pt.x);
+	    points.push_back(pt.y);
+	}
+
+	record(Lands, rec);
+    }
+}
+
+std::vector<uint8_t> Catalog::Writer::image(uint32_t source) const
+{
+    Header hdr;
+    std::memset(& hdr, 0, sizeof(hdr));
+    std::memcpy(hdr.magic, catalogMagic, sizeof(catalogMagic));
+
+    hdr.version = Version;
+    hdr.size = sizeof(Header);
+    hdr.source = source;
+
+    // tables aligned by 4
+    auto align = [](size_t pos){ return (pos + 3) & ~static_cast<size_t>(3); };
+    size_t pos = sizeof(Header);
+
+    for(int it = 0; it < SectionsCount; ++it)
+    {
+	hdr.sections[it] = Table{ static_cast<uint32_t>(pos), counts[it], strides[it] };
+	pos = align(pos + sections[it].size());
+    }
+
+    hdr.ids = Table{ static_cast<uint32_t>(pos), static_cast<uint32_t>(ids.size()), sizeof(int16_t) };
+    pos = align(pos + ids.size() * sizeof(int16_t));
+
+    hdr.points = Table{ static_cast<uint32_t>(pos), static_cast<uint32_t>(points.size() / 2), 2 * sizeof(int16_t) };
+    pos = align(pos + points.size() * sizeof(int16_t));
+
+    hdr.strings = Table{ static_cast<uint32_t>(pos), static_cast<uint32_t>(strings.size()), 1 };
+    pos += strings.size();
+
+    std::vector<uint8_t> res(pos, 0);
+    std::memcpy(res.data(), & hdr, sizeof(hdr));
+
+    for(int it = 0; it < SectionsCount; ++it)
+	if(sections[it].size())
+	    std::memcpy(res.data() + hdr.sections[it].offset, sections[it].data(), sections[it].size());
+
+    if(ids.size())
+	std::memcpy(res.data() + hdr.ids.offset, ids.data(), ids.size() * sizeof(int16_t));
+
+    if(points.size())
+	std::memcpy(res.data() + hdr.points.offset, points.data(), points.size() * sizeof(int16_t));
+
+    std::memcpy(res.data() + hdr.strings.offset, strings.data(), strings.size());
+
+    return res;
+}
+
+Catalog::Catalog() : header(nullptr)
+{
+}
+
+bool Catalog::attach(uint32_t source)
+{
+    const uint8_t* data = file.data();
+    const size_t size = file.size();
+    const Header* hdr = reinterpret_cast<const Header*>(data);
+
+    header = nullptr;
+
+    if(size < sizeof(Header) || 0 != std::memcmp(hdr->magic, catalogMagic, sizeof(catalogMagic)))
+    {
+	ERROR("unknown format");
+	return false;
+    }
+
+    if(hdr->version != Version || hdr->size != sizeof(Header))
+    {
+	ERROR("other version: " << hdr->version);
+	return false;
+    }
+
+    if(hdr->source != source)
+    {
+	VERBOSE("outdated, gamedata jsons changed");
+	return false;
+    }
+
+    auto inside = [=](const Table & tbl){ return tbl.offset <= size && tbl.count * static_cast<size_t>(tbl.stride) <= size - tbl.offset; };
+
+    if(! inside(hdr->strings) || ! inside(hdr->ids) || ! inside(hdr->points) ||
+	! std::all_of(std::begin(hdr->sections), std::end(hdr->sections), inside))
+    {
+	ERROR("table out of file");
+	return false;
+    }
+
+    // strings: terminated, offset 0 empty
+    if(0 == hdr->strings.count || 0 != data[hdr->strings.offset + hdr->strings.count - 1])
+    {
+	ERROR("string table error");
+	return false;
+    }
+
+    header = hdr;
+    return true;
+}
+
+bool Catalog::load(const std::string & path, uint32_t source)
+{
+    if(file.load(path) && attach(source))
+	return true;
+
+    file.release();
+    return false;
+}
+
+const char* Catalog::text(uint32_t offset) const
+{
+    const char* table = reinterpret_cast<const char*>(file.data() + header->strings.offset);
+    return offset < header->strings.count ? table + offset : table;
+}
+
+const int16_t* Catalog::idList(const uint32_t* list, uint32_t & count) const
+{
+    count = 0;
+
+    if(list[0] > header->ids.count || list[1] > header->ids.count - list[0])
+    {
+	ERROR("id list out of table");
+	return nullptr;
+    }
+
+    count = list[1];
+    return reinterpret_cast<const int16_t*>(file.data() + header->ids.offset) + list[0];
+}
+
+template<typename T>
+const T* Catalog::records(const section_t & section, uint32_t & count) const
+{
+    const Table & tbl = header->sections[section];
+    count = 0;
+
+    // empty section: without stride
+    if(tbl.count && tbl.stride != sizeof(T))
+    {
+	ERROR("record size: " << tbl.stride << ", " << "section: " << section);
+	return nullptr;
+    }
+
+    count = tbl.count;
+    return reinterpret_cast<const T*>(file.data() + tbl.offset);
+}
+
+bool Catalog::unpack(std::vector<StoneInfo> & v) const
+{
+    uint32_t count = 0;
+    const StoneRecord* recs = records<StoneRecord>(Stones, count);
+
+    if(! recs)
+	return false;
+
+    v.assign(count + 1, StoneInfo());
+
+    for(uint32_t it = 0; it < count; ++it)
+    {
+	const StoneRecord & rec = recs[it];
+	StoneInfo* info = placeInfo(v, Stone(static_cast<Stone::stone_t>(rec.id)));
+
+	if(! info)
+	    return false;
+
+	info->name = text(rec.name);
+	info->large = text(rec.large);
+	info->medium = text(rec.medium);
+	info->small = text(rec.small);
+    }
+
+    return true;
+}
+
+bool Catalog::unpack(std::vector<WindInfo> & v) const
+{
+    uint32_t count = 0;
+    const WindRecord* recs = records<WindRecord>(Winds, count);
+
+    if(! recs)
+	return false;
+
+    v.assign(count + 1, WindInfo());
+
+    for(uint32_t it = 0; it < count; ++it)
+    {
+	const WindRecord & rec = recs[it];
+	WindInfo* info = placeInfo(v, Wind(static_cast<Wind::wind_t>(rec.id)));
+
+	if(! info)
+	    return false;
+
+	info->name = _(text(rec.name));
+	info->image = text(rec.image);
+    }
+
+    return true;
+}
+
+bool Catalog::unpack(std::vector<ClanInfo> & v) const
+{
+    uint32_t count = 0;
+    const ClanRecord* recs = records<ClanRecord>(Clans, count);
+
+    if(! recs)
+	return false;
+
+    v.assign(count + 1, ClanInfo());
+
+    for(uint32_t it = 0; it < count; ++it)
+    {
+	const ClanRecord & rec = recs[it];
+	ClanInfo* info = placeInfo(v, Clan(static_cast<Clan::clan_t>(rec.id)));
+
+	if(! info)
+	    return false;
+
+	info->name = _(text(rec.name));
+	info->image = text(rec.image);
+	info->flag1 = text(rec.flag1);
+	info->flag2 = text(rec.flag2);
+	info->town = text(rec.town);
+	info->button = text(rec.button);
+	info->townflag1 = text(rec.townflag1);
+	info->townflag2 = text(rec.townflag2);
+    }
+
+    return true;
+}
+
+bool Catalog::unpack(std::vector<CreatureInfo> & v) const
+{
+    uint32_t count = 0;
+    const CreatureRecord* recs = records<CreatureRecord>(Creatures, count);
+
+    if(! recs)
+	return false;
+
+    v.assign(count + 1, CreatureInfo());
+
+    for(uint32_t it = 0; it < count; ++it)
+    {
+	const CreatureRecord & rec = recs[it];
+	CreatureInfo* info = placeInfo(v, Creature(static_cast<Creature::creature_t>(rec.id)));
+
+	if(! info)
+	    return false;
+
+	info->stat.attack = rec.stat[0];
+	info->stat.ranger = rec.stat[1];
+	info->stat.defense = rec.stat[2];
+	info->stat.loyalty = rec.stat[3];
+	info->stat.move = rec.stat[4];
+	info->cost = rec.cost;
+	info->specials = ::Specials(rec.specials);
+	info->unique = rec.unique;
+	info->fly = rec.fly;
+	info->name = _(text(rec.name));
+	info->image1 = text(rec.image1);
+	info->image2 = text(rec.image2);
+	info->description = _(text(rec.description));
+	info->sound1 = text(rec.sound1);
+
+	uint32_t stones = 0;
+	const int16_t* ids = idList(rec.stones, stones);
+
+	for(uint32_t pos = 0; pos < stones; ++pos)
+	    info->stones.push_back(Stone(static_cast<Stone::stone_t>(ids[pos])));
+    }
+
+    return true;
+}
+
+bool Catalog::unpack(std::vector<SpellInfo> & v) const
+{
+    uint32_t count = 0;
+    const SpellRecord* recs = records<SpellRecord>(Spells, count);
+
+    if(! recs)
+	return false;
+
+    v.assign(count + 1, SpellInfo());
+
+    for(uint32_t it = 0; it < count; ++it)
+    {
+	const SpellRecord & rec = recs[it];
+	SpellInfo* info = placeInfo(v, Spell(static_cast<Spell::spell_t>(rec.id)));
+
+	if(! info)
+	    return false;
+
+	info->target = SpellTarget(rec.target);
+	info->effect = BaseStat(rec.effect[0], rec.effect[1], rec.effect[2], rec.effect[3]);
+	info->cost = rec.cost;
+	info->extval = rec.extval;
+	info->persistent = rec.persistent;
+	info->name = _(text(rec.name));
+	info->image = text(rec.image);
+	info->description = _(text(rec.description));
+	info->sound = text(rec.sound);
+
+	uint32_t stones = 0;
+	const int16_t* ids = idList(rec.stones, stones);
+
+	for(uint32_t pos = 0; pos < stones; ++pos)
+	    info->stones.push_back(Stone(static_cast<Stone::stone_t>(ids[pos])));
+    }
+
+    return true;
+}
+
+bool Catalog::unpack(std::vector<SpecialityInfo> & v) const
+{
+    uint32_t count = 0;
+    const NoteRecord* recs = records<NoteRecord>(Specials, count);
+
+    if(! recs)
+	return false;
+
+    v.assign(count + 1, SpecialityInfo());
+
+    for(uint32_t it = 0; it < count; ++it)
+    {
+	const NoteRecord & rec = recs[it];
+	SpecialityInfo* info = placeInfo(v, Speciality(static_cast<Speciality::speciality_t>(rec.id)));
+
+	if(! info)
+	    return false;
+
+	info->name = _(text(rec.name));
+	info->description = _(text(rec.description));
+    }
+
+    return true;
+}
+
+bool Catalog::unpack(std::vector<AbilityInfo> & v) const
+{
+    uint32_t count = 0;
+    const NoteRecord* recs = records<NoteRecord>(Abilities, count);
+
+    if(! recs)
+	return false;
+
+    v.assign(count + 1, AbilityInfo());
+
+    for(uint32_t it = 0; it < count; ++it)
+    {
+	const NoteRecord & rec = recs[it];
+	AbilityInfo* info = placeInfo(v, Ability(static_cast<Ability::ability_t>(rec.id)));
+
+	if(! info)
+	    return false;
+
+	info->name = _(text(rec.name));
+	info->description = _(text(rec.description));
+    }
+
+    return true;
+}
+
+bool Catalog::unpack(std::vector<AvatarInfo> & v) const
+{
+    uint32_t count = 0;
+    const AvatarRecord* recs = records<AvatarRecord>(Avatars, count);
+
+    if(! recs)
+	return false;
+
+    v.assign(count + 1, AvatarInfo());
+
+    for(uint32_t it = 0; it < count; ++it)
+    {
+	const AvatarRecord & rec = recs[it];
+	AvatarInfo* info = placeInfo(v, Avatar(static_cast<Avatar::avatar_t>(rec.id)));
+
+	if(! info)
+	    return false;
+
+	info->ability = Ability(static_cast<Ability::ability_t>(rec.ability));
+	info->name = _(text(rec.name));
+	info->dignity = _(text(rec.dignity));
+	info->description = _(text(rec.description));
+	info->portrait = text(rec.portrait);
+	info->image = text(rec.image);
+
+	uint32_t size = 0;
+	const int16_t* ids = idList(rec.clans, size);
+
+	for(uint32_t pos = 0; pos < size; ++pos)
+	    info->clans.push_back(Clan(static_cast<Clan::clan_t>(ids[pos])));
+
+	ids = idList(rec.spells, size);
+
+	for(uint32_t pos = 0; pos < size; ++pos)
+	    info->spells.push_back(Spell(static_cast<Spell::spell_t>(ids[pos])));
+
+	ids = idList(rec.creatures, size);
+
+	for(uint32_t pos = 0; pos < size; ++pos)
+	    info->creatures.push_back(Creature(static_cast<Creature::creature_t>(ids[pos])));
+    }
+
+    return true;
+}
+
+bool Catalog::unpack(std::vector<LandInfo> & v) const
+{
+    uint32_t count = 0;
+    const LandRecord* recs = records<LandRecord>(Lands, count);
+
+    if(! recs)
+	return false;
+
+    v.assign(count + 1, LandInfo());
+
+    const int16_t* points = reinterpret_cast<const int16_t*>(file.data() + header->points.offset);
+
+    for(uint32_t it = 0; it < count; ++it)
+    {
+	const LandRecord & rec = recs[it];
+	LandInfo* info = placeInfo(v, Land(static_cast<Land::land_t>(rec.id)));
+
+	if(! info)
+	    return false;
+
+	info->clan = Clan(static_cast<Clan::clan_t>(rec.clan));
+	info->stat.attack = rec.stat[0];
+	info->stat.ranger = rec.stat[1];
+	info->stat.defense = rec.stat[2];
+	info->stat.loyalty = rec.stat[3];
+	info->stat.point = rec.stat[4];
+	info->stat.power = rec.power;
+	info->center = Point(rec.center[0], rec.center[1]);
+	info->area = Rect(rec.area[0], rec.area[1], rec.area[2], rec.area[3]);
+	info->iconrt = Rect(rec.iconrt[0], rec.iconrt[1], rec.iconrt[2], rec.iconrt[3]);
+	info->name = _(text(rec.name));
+
+	uint32_t size = 0;
+	const int16_t* ids = idList(rec.borders, size);
+
+	for(uint32_t pos = 0; pos < size; ++pos)
+	    info->borders.push_back(Land(static_cast<Land::land_t>(ids[pos])));
+
+	if(rec.points[0] > header->points.count || rec.points[1] > header->points.count - rec.points[0])
+	{
+	    ERROR("point list out of table");
+	    return false;
+	}
+
+	for(uint32_t pos = rec.points[0]; pos < rec.points[0] + rec.points[1]; ++pos)
+	    info->points.push_back(Point(points[2 * pos], points[2 * pos + 1]));
+    }
+
+    return true;
+}
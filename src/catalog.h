@@ -0,0 +1,134 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#ifndef _RWNA_CATALOG_
+#define _RWNA_CATALOG_
+
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <unordered_map>
+
+#include "mappedfile.h"
+
+struct StoneInfo;
+struct WindInfo;
+struct ClanInfo;
+struct CreatureInfo;
+struct SpellInfo;
+struct SpecialityInfo;
+struct AbilityInfo;
+struct AvatarInfo;
+struct LandInfo;
+
+/* gamedata jsons compiled to one image: fixed layout records, string and id tables */
+class Catalog
+{
+public:
+    enum { Version = 1 };
+    enum section_t { Stones, Winds, Clans, Creatures, Spells, Specials, Abilities, Avatars, Lands, SectionsCount };
+
+    struct Table
+    {
+	uint32_t		offset;
+	uint32_t		count;
+	uint32_t		stride; /* record size */
+    };
+
+    /* file layout, native byte order */
+    struct Header
+    {
+	char			magic[4];
+	uint32_t		version;
+	uint32_t		size; /* sizeof(Header) */
+	uint32_t		source; /* jsons size and time */
+	Table			strings;
+	Table			ids;
+	Table			points;
+	Table			sections[SectionsCount];
+    };
+
+    /* strings stored untranslated, as in json */
+    class Writer
+    {
+	std::vector<char>	strings;
+	std::unordered_map<std::string, uint32_t> offsets;
+	std::vector<int16_t>	ids;
+	std::vector<int16_t>	points;
+	std::array<std::vector<uint8_t>, SectionsCount> sections;
+	std::array<uint32_t, SectionsCount> counts;
+	std::array<uint32_t, SectionsCount> strides;
+
+	uint32_t		string(const std::string &);
+	template<typename Iter>
+	void			idList(Iter, Iter, uint32_t* res);
+	template<typename T>
+	void			record(const section_t &, const T &);
+
+    public:
+	Writer();
+
+	void			add(const std::vector<StoneInfo> &);
+	void			add(const std::vector<WindInfo> &);
+	void			add(const std::vector<ClanInfo> &);
+	void			add(const std::vector<CreatureInfo> &);
+	void			add(const std::vector<SpellInfo> &);
+	void			add(const std::vector<SpecialityInfo> &);
+	void			add(const std::vector<AbilityInfo> &);
+	void			add(const std::vector<AvatarInfo> &);
+	void			add(const std::vector<LandInfo> &);
+
+	std::vector<uint8_t>	image(uint32_t source) const;
+    };
+
+protected:
+    MappedFile			file;
+    const Header*		header;
+
+    bool			attach(uint32_t source);
+    const char*			text(uint32_t) const; /* in the string table */
+    const int16_t*		idList(const uint32_t*, uint32_t & count) const;
+    template<typename T>
+    const T*			records(const section_t &, uint32_t & count) const;
+
+public:
+    Catalog();
+
+    /* mmap of compiled file, false: absent, stale or other layout */
+    bool			load(const std::string & path, uint32_t source);
+    bool			isValid(void) const { return header; }
+
+    /* same vectors as json loader: index by id, translated strings */
+    bool			unpack(std::vector<StoneInfo> &) const;
+    bool			unpack(std::vector<WindInfo> &) const;
+    bool			unpack(std::vector<ClanInfo> &) const;
+    bool			unpack(std::vector<CreatureInfo> &) const;
+    bool			unpack(std::vector<SpellInfo> &) const;
+    bool			unpack(std::vector<SpecialityInfo> &) const;
+    bool			unpack(std::vector<AbilityInfo> &) const;
+    bool			unpack(std::vector<AvatarInfo> &) const;
+    bool			unpack(std::vector<LandInfo> &) const;
+};
+
+#endif
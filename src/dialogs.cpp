@@ -841,23 +841,13 @@ void MapStatusDialog::renderWindSection(const RemotePlayer & player, const Point
     // avatar point
     renderText(defaultFont, String::number(player.points), textColor, pos + offsetTextPoint);
 
-    const Lands lands = player.lands();
+    const ClanLands & lands = GameData::clanLands(player.clan);
 
     // lands count
-    renderText(defaultFont, String::number(lands.size()), textColor, pos + offsetTextLands);
+    renderText(defaultFont, String::number(lands.count), textColor, pos + offsetTextLands);
 
-    int landPower = 0;
-    int landPoint = 0;
-
-    for(auto & land : lands)
-    {
-	const LandInfo & info = GameData::landInfo(land);
-	if(info.stat.power) landPower++;
-	landPoint += info.stat.point;
-    }
-
-    renderText(defaultFont, String::number(landPoint), textColor, pos + offsetTextLandPoint);
-    renderText(defaultFont, String::number(landPower), textColor, pos + offsetTextLandPower);
+    renderText(defaultFont, String::number(lands.points), textColor, pos + offsetTextLandPoint);
+    renderText(defaultFont, String::number(lands.powers), textColor, pos + offsetTextLandPower);
 
     int index = 0;
     // render other clan icons
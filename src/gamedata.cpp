@@ -25,9 +25,12 @@
 #include <algorithm>
 
 #include "settings.h"
-#include "aiturn.h"
+#include "aisearch.h"
+#include "aimcts.h"
 #include "actions.h"
 #include "battle.h"
+#include "landmap.h"
+#include "catalog.h"
 #include "gamedata.h"
 
 std::string SpellInfo::effectDescription(void) const
@@ -90,6 +93,8 @@ namespace GameData
     std::vector<AbilityInfo>		abilitiesInfo;
     std::vector<AvatarInfo>		avatarsInfo;
     std::vector<LandInfo>		landsInfo;
+    LandMap				landsMap;
+    ScoreTable				scoringTable;
 
     int					bonusStart;
     int					bonusGame;
@@ -118,13 +123,21 @@ namespace GameData
     }
 
     bool 		loadIndexes(const JsonObject &);
+    uint32_t		resourceStamp(const char*, uint32_t seed);
+    uint32_t		landMapSource(void);
+    bool		compileLandMap(std::vector<uint8_t> &, uint32_t source);
+    uint32_t		catalogSource(void);
+    bool		loadJsons(void);
+    bool		loadCatalog(void);
+    void		initLandsClan(GameSession &);
+    void		initClanLands(GameSession &);
 
     LocalPlayer &	playerOfClan(const Clan &);
     LocalPlayer &	playerOfAvatar(const Avatar &);
     LocalPlayer &	playerOfWind(const Wind &);
 }
 
-bool GameData::init(const JsonObject & jo)
+bool GameData::init(const JsonObject & jo, bool compiled)
 {
     if(! loadIndexes(jo))
 	return false;
@@ -135,7 +148,58 @@ bool GameData::init(const JsonObject & jo)
     bonusPung = jo.getInteger("bonus:pung", 30);
     bonusKong = jo.getInteger("bonus:kong", 40);
 
-    // load game jsons
+    // game catalogs: compiled gamedata.cat, jsons if absent or changed (mods)
+    if(compiled && loadCatalog())
+	VERBOSE("game catalog: compiled");
+    else
+    if(! loadJsons())
+	return false;
+
+    // scoring rules: required, a theme copies them from the default theme
+    if(! GameTheme::findResource("scoring.json"))
+    {
+	ERROR("scoring.json not found, theme: " << GameTheme::name());
+	return false;
+    }
+
+    if(! scoringTable.load(GameTheme::jsonResource("scoring.json").toObject()))
+	return false;
+
+    initLandsClan(session());
+
+    // runes requirement: stones count
+    for(auto & info : creaturesInfo)
+	info.runes = RuneCounts(info.stones);
+
+    for(auto & info : spellsInfo)
+	info.runes = RuneCounts(info.stones);
+
+    // asset compilers: lands map built by the tool
+    if(! compiled)
+	return true;
+
+    // lands graph and geometry: compiled lands.map, validated by build
+    const uint32_t landSource = landMapSource();
+    std::string path;
+
+    if(! GameTheme::findCompiled("lands.map", & path) || ! landsMap.load(path, landSource))
+    {
+	std::vector<uint8_t> blob;
+
+	if(! compileLandMap(blob, landSource) || ! landsMap.assign(std::move(blob), landSource))
+	{
+	    ERROR("lands map: error");
+	    return false;
+	}
+
+	VERBOSE("lands map: build at start");
+    }
+
+    return true;
+}
+
+bool GameData::loadJsons(void)
+{
     if(! loadJson<StoneInfo>("stones.json", stonesInfo))
 	return false;
 
@@ -163,27 +227,101 @@ bool GameData::init(const JsonObject & jo)
     if(! loadJson<LandInfo>("lands.json", landsInfo))
 	return false;
 
-    // check path valid
-    for(auto & info1 : landsInfo)
-    {
-        const Land & land1 = info1.id;
-        for(auto & land2 : info1.borders)
-        {
-            const LandInfo & info2 = landInfo(land2);
+    return true;
+}
 
-            if(std::none_of(info2.borders.begin(), info2.borders.end(), [&](const Land & land){ return land == land1; }))
-                ERROR("land path error: " << land1.toString() << "<->" << land2.toString());
-        }
-    }
+bool GameData::loadCatalog(void)
+{
+    std::string path;
+    Catalog catalog;
+
+    if(! GameTheme::findCompiled("gamedata.cat", & path) || ! catalog.load(path, catalogSource()))
+	return false;
+
+    return catalog.unpack(stonesInfo) && catalog.unpack(windsInfo) && catalog.unpack(clansInfo) &&
+	catalog.unpack(creaturesInfo) && catalog.unpack(spellsInfo) && catalog.unpack(specialsInfo) &&
+	catalog.unpack(abilitiesInfo) && catalog.unpack(avatarsInfo) && catalog.unpack(landsInfo);
+}
+
+uint32_t GameData::catalogSource(void)
+{
+    const char* jsons[] = { "stones.json", "winds.json", "clans.json", "creatures.json", "spells.json",
+				"specials.json", "abilities.json", "avatars.json", "lands.json" };
+    uint32_t res = 2166136261u;
+
+    for(auto & json : jsons)
+	res = resourceStamp(json, res);
+
+    return res;
+}
+
+bool GameData::compileCatalog(std::vector<uint8_t> & blob)
+{
+    // from json data: strings untranslated only without domain (headless)
+    Catalog::Writer writer;
+
+    writer.add(stonesInfo);
+    writer.add(windsInfo);
+    writer.add(clansInfo);
+    writer.add(creaturesInfo);
+    writer.add(spellsInfo);
+    writer.add(specialsInfo);
+    writer.add(abilitiesInfo);
+    writer.add(avatarsInfo);
+    writer.add(landsInfo);
 
+    blob = writer.image(catalogSource());
     return true;
 }
 
+uint32_t GameData::resourceStamp(const char* name, uint32_t seed)
+{
+    std::string path;
+
+    // size and time of file, not read: content only for packed resources
+    if(GameTheme::findResource(name, & path) && MappedFile::stamp(path, seed))
+	return seed;
+
+    const BinaryBuf & buf = GameTheme::readResource(name);
+    return MappedFile::checksum(buf.data(), buf.size(), seed);
+}
+
+uint32_t GameData::landMapSource(void)
+{
+    return resourceStamp("lands.json", 2166136261u);
+}
+
+bool GameData::compileLandMap(std::vector<uint8_t> & blob, uint32_t source)
+{
+    std::vector<const LandInfo*> lands;
+    lands.reserve(lands_all.size());
+
+    for(auto & id : lands_all)
+	lands.push_back(& landInfo(id));
+
+    return LandMap::compile(lands, source, blob);
+}
+
+bool GameData::compileLandMap(std::vector<uint8_t> & blob)
+{
+    return compileLandMap(blob, landMapSource());
+}
+
+const LandMap & GameData::landMap(void)
+{
+    return landsMap;
+}
+
 const LandInfo & GameData::landInfo(const Land & landId)
 {
     return landsInfo[landId()];
 }
 
+const ScoreTable & GameData::scoreTable(void)
+{
+    return scoringTable;
+}
+
 const AvatarInfo & GameData::avatarInfo(const Avatar & avatarId)
 {
     return avatarsInfo[avatarId()];
@@ -304,23 +442,9 @@ Persons LocalData::toPersons(void) const
 
 namespace GameData
 {
-    // remote data
-    Person				person;
-    LocalPlayers			gamers;
-    Wind				currentWind;
-    Wind				roundWind;
-    Wind				partWind;
-    CroupierSet				croupier;
-    int					stoneLastCount = 0;
-    Stone				dropStone;
-    WinResults				winResult;
-    std::list<BattleLegend>		battleHistory;
-    bool				skipRepeatSay = false;
-    bool				skipNewStone = false;
-    bool				skipNewTurn = false;
-    int					gamePart = 0;
-    int					battleUnitId = 1;
-    JsonObject				stateGUI;
+    // main session: game with display
+    GameSession				mainSession;
+    thread_local GameSession*		currentSession = nullptr;
 
     Wind                                prevWindCompass(const Wind &);
     Wind                                nextWindCompass(const Wind &);
@@ -330,6 +454,7 @@ namespace GameData
     void				validateMahjongSummary(void);
 
     bool				adventureBattleAction(const Avatar &, ActionList &);
+    bool				mahjongPass(bool shiftWind, ActionList &);
 
     bool				clientReady(const Avatar &, const ClientMessage &, ActionList &);
     bool				clientSayGame(const Avatar &, const ClientMessage &, ActionList &);
@@ -352,21 +477,91 @@ namespace GameData
     bool				fromJsonObject(const JsonObject &);
 }
 
+GameSession & GameData::session(void)
+{
+    return currentSession ? *currentSession : mainSession;
+}
+
+void GameData::setSession(GameSession* gs)
+{
+    currentSession = gs;
+}
+
+Clan GameData::landClan(const Land & land)
+{
+    return session().landsClan.clan(land);
+}
+
+void GameData::setLandClan(const Land & land, const Clan & clan)
+{
+    GameSession & gs = session();
+
+    gs.clanLands[gs.landsClan[land()]].remove(land);
+    gs.landsClan.setClan(land, clan);
+    gs.clanLands[clan()].add(land);
+}
+
+const LandOwners & GameData::landOwners(void)
+{
+    return session().landsClan;
+}
+
+const ClanLands & GameData::clanLands(const Clan & clan)
+{
+    return session().clanLands[clan()];
+}
+
+void GameData::initClanLands(GameSession & gs)
+{
+    gs.clanLands.fill(ClanLands());
+
+    for(auto & id : lands_all)
+	gs.clanLands[gs.landsClan[id]].add(Land(id));
+}
+
+void GameData::initLandsClan(GameSession & gs)
+{
+    // new game: start owners from catalog
+    gs.landsClan = LandOwners();
+
+    for(auto & info : landsInfo)
+	if(info.id.isValid()) gs.landsClan.setClan(info.id, info.clan);
+
+    initClanLands(gs);
+}
+
 int GameData::nextBattleUnitId(void)
 {
-    return battleUnitId++;
+    return session().battleUnitId++;
+}
+
+std::mt19937 & GameData::randomEngine(void)
+{
+    return session().randomGen;
+}
+
+void GameData::setRandomSeed(unsigned int seed)
+{
+    session().randomGen.seed(seed);
+}
+
+int GameData::random(int min, int max)
+{
+    return std::uniform_int_distribution<int>(min, max)(session().randomGen);
 }
 
 bool GameData::isGameOver(void)
 {
-    return roundWind() == Wind::North && partWind() == Wind::North;
+    GameSession & gs = session();
+
+    return gs.roundWind() == Wind::North && gs.partWind() == Wind::North;
 }
 
 std::list<BattleLegend> GameData::getBattleHistoryFor(const Avatar & avatar)
 {
     std::list<BattleLegend> res;
 
-    for(auto & legend : battleHistory)
+    for(auto & legend : session().battleHistory)
 	if(legend.attacker == avatar) res.push_back(legend);
 
     return res;
@@ -374,52 +569,58 @@ std::list<BattleLegend> GameData::getBattleHistoryFor(const Avatar & avatar)
 
 const JsonObject & GameData::jsonGUI(void)
 {
-    return stateGUI;
+    return session().stateGUI;
 }
 
 void GameData::setGamePart(int v)
 {
-    gamePart = v;
+    GameSession & gs = session();
+
+    gs.gamePart = v;
 
     if(v == Menu::AdventurePart)
     {
-	for(auto & player : gamers)
+	for(auto & player : gs.gamers)
             player.initAdventurePart();
     }
 }
 
 int GameData::loadedGamePart(void)
 {
-    return gamePart;
+    return session().gamePart;
 }
 
 const Person & GameData::myPerson(void)
 {
-    return person;
+    return session().person;
 }
 
 JsonObject GameData::toJsonObject(const JsonObject & gui)
 {
+    GameSession & gs = session();
+
     JsonObject jo;
     jo.addInteger("version", FORMAT_VERSION_CURRENT);
-    jo.addString("wind:round", roundWind.toString());
-    jo.addString("wind:part", partWind.toString());
-    jo.addString("wind:current", currentWind.toString());
-    jo.addInteger("lastcount", stoneLastCount);
-    jo.addString("stone:drop", dropStone.toString());
-    jo.addBoolean("skiprepeat", skipRepeatSay);
-    jo.addBoolean("skipnew", skipNewStone);
-    jo.addBoolean("skipturn", skipNewTurn);
-    jo.addInteger("gamepart", gamePart);
-    jo.addInteger("nextBattleUnitId", battleUnitId);
-
-    jo.addObject("myperson", person.toJsonObject());
-    jo.addObject("croupier", croupier.toJsonObject());
-    jo.addObject("winresult", winResult.toJsonObject());
-    jo.addArray("players", gamers.toJsonArray());
+    jo.addString("wind:round", gs.roundWind.toString());
+    jo.addString("wind:part", gs.partWind.toString());
+    jo.addString("wind:current", gs.currentWind.toString());
+    jo.addInteger("lastcount", gs.stoneLastCount);
+    jo.addString("stone:drop", gs.dropStone.toString());
+    jo.addBoolean("skiprepeat", gs.skipRepeatSay);
+    jo.addBoolean("skipnew", gs.skipNewStone);
+    jo.addBoolean("skipturn", gs.skipNewTurn);
+    jo.addInteger("gamepart", gs.gamePart);
+    jo.addInteger("nextBattleUnitId", gs.battleUnitId);
+
+    jo.addObject("myperson", gs.person.toJsonObject());
+    jo.addObject("croupier", gs.croupier.toJsonObject());
+    jo.addObject("winresult", gs.winResult.toJsonObject());
+    jo.addArray("players", gs.gamers.toJsonArray());
+
+    jo.addArray("lands", gs.landsClan.toJsonArray());
 
     JsonArray ja;
-    for(auto & legend : battleHistory)
+    for(auto & legend : gs.battleHistory)
 	ja.addObject(legend.toJsonObject());
     jo.addArray("history", ja);
 
@@ -430,6 +631,8 @@ JsonObject GameData::toJsonObject(const JsonObject & gui)
 
 bool GameData::fromJsonObject(const JsonObject & jo)
 {
+    GameSession & gs = session();
+
     int version = jo.getInteger("version");
 
     if(version < FORMAT_VERSION_LAST || version > FORMAT_VERSION_CURRENT)
@@ -441,16 +644,16 @@ bool GameData::fromJsonObject(const JsonObject & jo)
 
     VERBOSE("load gamedata, version: " << version);
 
-    stoneLastCount = jo.getInteger("lastcount");
-    roundWind = Wind(jo.getString("wind:round"));
-    partWind = Wind(jo.getString("wind:part"));
-    currentWind = Wind(jo.getString("wind:current"));
-    dropStone = Stone(jo.getString("stone:drop"));
-    skipNewStone = jo.getBoolean("skipnew");
-    skipNewTurn = jo.getBoolean("skipturn");
-    skipRepeatSay = false; // initial say need! jo.getBoolean("skiprepeat");
-    gamePart = jo.getInteger("gamepart");
-    battleUnitId = jo.getInteger("nextBattleUnitId");
+    gs.stoneLastCount = jo.getInteger("lastcount");
+    gs.roundWind = Wind(jo.getString("wind:round"));
+    gs.partWind = Wind(jo.getString("wind:part"));
+    gs.currentWind = Wind(jo.getString("wind:current"));
+    gs.dropStone = Stone(jo.getString("stone:drop"));
+    gs.skipNewStone = jo.getBoolean("skipnew");
+    gs.skipNewTurn = jo.getBoolean("skipturn");
+    gs.skipRepeatSay = false; // initial say need! jo.getBoolean("skiprepeat");
+    gs.gamePart = jo.getInteger("gamepart");
+    gs.battleUnitId = jo.getInteger("nextBattleUnitId");
 
     const JsonObject* jo2 = nullptr;
 
@@ -460,7 +663,7 @@ bool GameData::fromJsonObject(const JsonObject & jo)
 	ERROR("json parse: " << "myperson");
 	return false;
     }
-    person = Person::fromJsonObject(*jo2);
+    gs.person = Person::fromJsonObject(*jo2);
 
     jo2 = jo.getObject("croupier");
     if(! jo2)
@@ -468,7 +671,7 @@ bool GameData::fromJsonObject(const JsonObject & jo)
 	ERROR("json parse: " << "croupier");
 	return false;
     }
-    croupier = CroupierSet::fromJsonObject(*jo2);
+    gs.croupier = CroupierSet::fromJsonObject(*jo2);
 
     jo2 = jo.getObject("winresult");
     if(! jo2)
@@ -476,7 +679,7 @@ bool GameData::fromJsonObject(const JsonObject & jo)
 	ERROR("json parse: " << "winresult");
 	return false;
     }
-    winResult = WinResults::fromJsonObject(*jo2);
+    gs.winResult = WinResults::fromJsonObject(*jo2);
 
     const JsonArray* ja2 = nullptr;
 
@@ -486,9 +689,25 @@ bool GameData::fromJsonObject(const JsonObject & jo)
 	ERROR("json parse: " << "players");
 	return false;
     }
-    gamers = LocalPlayers::fromJsonArray(*ja2);
+    gs.gamers = LocalPlayers::fromJsonArray(*ja2);
+
+    // old saves: without owners, start owners
+    if(version < FORMAT_VERSION_20261019)
+	initLandsClan(gs);
+    else
+    {
+	ja2 = jo.getArray("lands");
+	if(! ja2)
+	{
+	    ERROR("json parse: " << "lands");
+	    return false;
+	}
+
+	gs.landsClan = LandOwners::fromJsonArray(*ja2);
+	initClanLands(gs);
+    }
 
-    battleHistory.clear();
+    gs.battleHistory.clear();
 
     ja2 = jo.getArray("history");
     if(! ja2)
@@ -500,13 +719,16 @@ bool GameData::fromJsonObject(const JsonObject & jo)
     for(int it = 0; it < ja2->size(); ++it)
     {
 	jo2 = ja2->getObject(it);
-	if(jo2) battleHistory.push_back(BattleLegend::fromJsonObject(*jo2));
+	if(jo2) gs.battleHistory.push_back(BattleLegend::fromJsonObject(*jo2));
     }
 
-    stateGUI.clear();
+    gs.tiles.rebuild(gs.croupier.trash, gs.gamers, gs.dropStone);
+    gs.aiSearch.reset();
+    gs.aiMoves.reset();
+    gs.stateGUI.clear();
 
     jo2 = jo.getObject("gui");
-    if(jo2) stateGUI = *jo2;
+    if(jo2) gs.stateGUI = *jo2;
 
     return true;
 }
@@ -536,7 +758,9 @@ bool GameData::loadGame(const std::string & fn)
 
 LocalData GameData::toLocalData(const Avatar & ava)
 {
-    LocalPlayer* lp = gamers.playerOfAvatar(ava);
+    GameSession & gs = session();
+
+    LocalPlayer* lp = gs.gamers.playerOfAvatar(ava);
 
     if(! lp)
     {
@@ -548,30 +772,30 @@ LocalData GameData::toLocalData(const Avatar & ava)
     const AvatarInfo & avaInfo = avatarInfo(ava);
 
     LocalData ld;
-    ld.trashSet = croupier.trash;
+    ld.trashSet = gs.croupier.trash;
 
-    ld.roundWind = roundWind;
-    ld.partWind = partWind;
-    ld.currentWind = currentWind;
+    ld.roundWind = gs.roundWind;
+    ld.partWind = gs.partWind;
+    ld.currentWind = gs.currentWind;
     ld.compass = WindCompass(wind);
-    ld.dropStone = dropStone;
-    ld.stoneLastCount = stoneLastCount;
-    ld.winResult = winResult;
+    ld.dropStone = gs.dropStone;
+    ld.stoneLastCount = gs.stoneLastCount;
+    ld.winResult = gs.winResult;
 
 
-    lp = gamers.playerOfWind(ld.compass.left());
+    lp = gs.gamers.playerOfWind(ld.compass.left());
     if(lp) ld.players[0] = *lp;
     else ERROR("player not found" << ", wind: " << ld.compass.left().toString());
 
-    lp = gamers.playerOfWind(ld.compass.right());
+    lp = gs.gamers.playerOfWind(ld.compass.right());
     if(lp) ld.players[1] = *lp;
     else ERROR("player not found" << ", wind: " << ld.compass.right().toString());
 
-    lp = gamers.playerOfWind(ld.compass.top());
+    lp = gs.gamers.playerOfWind(ld.compass.top());
     if(lp) ld.players[2] = *lp;
     else ERROR("player not found" << ", wind: " << ld.compass.top().toString());
 
-    lp = gamers.playerOfWind(ld.compass.bottom());
+    lp = gs.gamers.playerOfWind(ld.compass.bottom());
     if(lp) ld.players[3] = *lp;
     else ERROR("player not found" << ", wind: " << ld.compass.bottom().toString());
 
@@ -604,7 +828,7 @@ BattleArmy & GameData::getBattleArmy(const Clan & clan)
 
 bool GameData::findCreatureUnique(const Creature & cr)
 {
-    for(auto & player : gamers)
+    for(auto & player : session().gamers)
 	if(player.army.findCreature(cr)) return true;
 
     return false;
@@ -614,10 +838,10 @@ BattleParty* GameData::getBattleParty(int unit)
 {
     if(0 < unit)
     {
-	for(auto & player : gamers)
+	for(auto & player : session().gamers)
 	{
-	    for(auto & party : player.army)
-		if(party.findBattleUnitConst(unit)) return & party;
+	    auto party = player.army.findPartyOfUnit(unit);
+	    if(party) return party;
 	}
     }
 
@@ -631,7 +855,7 @@ BattleCreature* GameData::getBattleCreature(int unit)
 {
     if(0 < unit)
     {
-	for(auto & player : gamers)
+	for(auto & player : session().gamers)
 	{
 	    auto bcr = player.army.findBattleUnit(unit);
 	    if(bcr) return bcr;
@@ -646,7 +870,7 @@ BattleCreature* GameData::getBattleCreature(int unit)
 
 RemotePlayer* GameData::getBattleArmyOwner(const BattleArmy & army)
 {
-    for(auto & player : gamers)
+    for(auto & player : session().gamers)
 	if(& player.army == & army) return & player;
 
     ERROR("battle army not found");
@@ -670,68 +894,86 @@ Wind GameData::prevWindCompass(const Wind & wind)
     return wind.isValid() ? WindCompass(wind).left() : Wind(Wind::North);
 }
 
-void GameData::initPersons(const Person & cur)
+void GameData::initPersons(const Person & cur, bool allAI)
 {
+    GameSession & gs = session();
+
     Persons persons(cur);
-    gamers.setPersons(persons);
+    gs.gamers.setPersons(persons);
+
+    // headless game: simulations, benchmarks
+    if(allAI)
+    {
+	for(auto & player : gs.gamers)
+	    player.setAI(true);
+    }
+
+    initLandsClan(gs);
 
-    person = cur;
-    roundWind = Wind(Wind::None);
-    partWind = Wind(Wind::None);
-    currentWind = Wind(Wind::None);
+    gs.battleHistory.clear();
+    gs.battleUnitId = 1;
+
+    gs.person = cur;
+    gs.roundWind = Wind(Wind::None);
+    gs.partWind = Wind(Wind::None);
+    gs.currentWind = Wind(Wind::None);
 }
 
 bool GameData::initMahjong(void)
 {
+    GameSession & gs = session();
+
     do
     {
-	for(auto & lp : gamers)
+	for(auto & lp : gs.gamers)
 	    lp.initMahjongPart();
 
-	croupier.reset();
-	gamers.distributeStones(croupier);
+	gs.croupier.reset();
+	gs.gamers.distributeStones(gs.croupier);
     }
     // fix kong startup
-    while(gamers.findKongs());
+    while(gs.gamers.findKongs());
 
-    stoneLastCount = GAME_STONE_MAX;
-    skipRepeatSay = false;
-    gamePart = Menu::MahjongPart;
-    skipNewStone = false;
-    skipNewTurn = false;
-    stateGUI.clear();
+    gs.stoneLastCount = GAME_STONE_MAX;
+    gs.skipRepeatSay = false;
+    gs.gamePart = Menu::MahjongPart;
+    gs.skipNewStone = false;
+    gs.skipNewTurn = false;
+    gs.stateGUI.clear();
+    gs.aiSearch.reset();
 
-    if(partWind() == Wind::North && roundWind() == Wind::North)
+    if(gs.partWind() == Wind::North && gs.roundWind() == Wind::North)
 	return false;
     else
-    if(! partWind.isValid() && ! roundWind.isValid())
+    if(! gs.partWind.isValid() && ! gs.roundWind.isValid())
     {
 	// new round, new part
-        partWind = Wind(Wind::East);
-        roundWind = Wind(Wind::East);
+        gs.partWind = Wind(Wind::East);
+        gs.roundWind = Wind(Wind::East);
     }
     else
-    if(partWind() == Wind::North)
+    if(gs.partWind() == Wind::North)
     {
 	// new round, new part
-	roundWind.shift();
-	partWind = Wind(Wind::East);
+	gs.roundWind.shift();
+	gs.partWind = Wind(Wind::East);
     }
     else
     {
 	// new part
-	gamers.shiftWinds();
-	partWind.shift();
+	gs.gamers.shiftWinds();
+	gs.partWind.shift();
     }
 
-    currentWind = Wind(Wind::East);
-    dropStone = Stone(Stone::None);
-    winResult = WinResults();
+    gs.currentWind = Wind(Wind::East);
+    gs.dropStone = Stone(Stone::None);
+    gs.winResult = WinResults();
+    gs.tiles.rebuild(gs.croupier.trash, gs.gamers, gs.dropStone);
 
-    battleHistory.clear();
+    gs.battleHistory.clear();
 
-    VERBOSE("wind round: " << roundWind.toString());
-    VERBOSE("wind part: " << partWind.toString());
+    VERBOSE("wind round: " << gs.roundWind.toString());
+    VERBOSE("wind part: " << gs.partWind.toString());
 
     dumpOrderPersons();
     return true;
@@ -752,7 +994,7 @@ void GameData::dumpOrderPersons(void)
 
 LocalPlayer & GameData::playerOfAvatar(const Avatar & avatar)
 {
-    LocalPlayer* res = gamers.playerOfAvatar(avatar);
+    LocalPlayer* res = session().gamers.playerOfAvatar(avatar);
 
     if(! res)
     {
@@ -765,7 +1007,7 @@ LocalPlayer & GameData::playerOfAvatar(const Avatar & avatar)
 
 LocalPlayer & GameData::playerOfClan(const Clan & clan)
 {
-    LocalPlayer* res = gamers.playerOfClan(clan);
+    LocalPlayer* res = session().gamers.playerOfClan(clan);
 
     if(! res)
     {
@@ -778,7 +1020,7 @@ LocalPlayer & GameData::playerOfClan(const Clan & clan)
 
 LocalPlayer & GameData::playerOfWind(const Wind & wind)
 {
-    LocalPlayer* res = gamers.playerOfWind(wind);
+    LocalPlayer* res = session().gamers.playerOfWind(wind);
 
     if(! res)
     {
@@ -791,68 +1033,76 @@ LocalPlayer & GameData::playerOfWind(const Wind & wind)
 
 bool GameData::mahjong2Client(const Avatar & avatar, ActionList & actions)
 {
-    LocalPlayer & current = playerOfWind(currentWind);
+    GameSession & gs = session();
+
+    // ai drop search in progress
+    if(gs.aiSearch)
+	return AI::mahjongPendingDrop(actions);
 
-    if(current.newStone.isValid() || skipNewTurn)
+    LocalPlayer & current = playerOfWind(gs.currentWind);
+
+    if(current.newStone.isValid() || gs.skipNewTurn)
     {
-	//DEBUG("wind: " << currentWind.toString() << ", " << "person: " << current.name() << ", " << 
+	//DEBUG("wind: " << gs.currentWind.toString() << ", " << "person: " << current.name() << ", " << 
 	//	"new stone: " << current.newStone() << ", " << "wait action");
 	return false;
     }
     else
-    if(dropStone.isValid())
+    if(gs.dropStone.isValid())
     {
-	if(skipRepeatSay)
+	if(gs.skipRepeatSay)
+	{
+	    // all ai game: nobody to wait pass
+	    if(gs.gamers.isAllAI())
+		return mahjongPass(true, actions);
+
 	    return false;
+	}
 
-	skipRepeatSay = true;
+	gs.skipRepeatSay = true;
 
-	if(AI::mahjongGameKongPungChao(currentWind, roundWind, dropStone, winResult, actions, true))
+	if(AI::mahjongGameKongPungChao(gs.currentWind, gs.roundWind, gs.dropStone, gs.winResult, actions, true))
 	    return true;
 
 	DEBUG("wait player pass" << ", " << "current: " << current.toString());
 	return false;
     }
 
-    DEBUG("new turn: " << "last count: " << stoneLastCount);
+    DEBUG("new turn: " << "last count: " << gs.stoneLastCount);
 
-    if(0 == stoneLastCount)
+    if(0 == gs.stoneLastCount)
     {
-	actions.push_back(MahjongEnd(currentWind));
+	actions.push_back(MahjongEnd(gs.currentWind));
 	validateMahjongSummary();
-    	gamePart = Menu::MahjongSummaryPart;
+    	gs.gamePart = Menu::MahjongSummaryPart;
 	return true;
     }
 
     bool showGame2 = false;
     bool showKong2 = false;
 
-    current.newTurnEvent(croupier, skipNewStone);
+    current.newTurnEvent(gs.croupier, gs.skipNewStone);
 
-    if(! skipNewStone)
+    if(! gs.skipNewStone)
     {
-	stoneLastCount--;
+	gs.stoneLastCount--;
 
-	showGame2 = current.isWinMahjong(currentWind, roundWind, dropStone, & winResult);
-	showKong2 = current.isMahjongKong2(currentWind);
+	showGame2 = current.isWinMahjong(gs.currentWind, gs.roundWind, gs.dropStone, & gs.winResult);
+	showKong2 = current.isMahjongKong2(gs.currentWind);
     }
     else
     {
-	skipNewTurn = true;
+	gs.skipNewTurn = true;
     }
 
     if(current.isAI())
     {
-	const WinRules & left = playerOfWind(prevWindCompass(currentWind)).rules;
-	const WinRules & right = playerOfWind(nextWindCompass(currentWind)).rules;
-	const WinRules & top = playerOfWind(oppositeWindCompass(currentWind)).rules;
-
-	AI::mahjongTurn(currentWind, current.avatar, croupier.trash, left, right, top, showGame2, showKong2, actions);
+	AI::mahjongTurn(gs.currentWind, current.avatar, showGame2, showKong2, actions);
     }
     else
     {
-	actions.push_back(MahjongTurn(currentWind, current.newStone, showKong2, showGame2));
-	actions.push_back(MahjongData(currentWind));
+	actions.push_back(MahjongTurn(gs.currentWind, current.newStone, showKong2, showGame2));
+	actions.push_back(MahjongData(gs.currentWind));
     }
 
     return true;
@@ -860,25 +1110,29 @@ bool GameData::mahjong2Client(const Avatar & avatar, ActionList & actions)
 
 bool GameData::clientReady(const Avatar & avatar, const ClientMessage & act, ActionList & actions)
 {
+    GameSession & gs = session();
+
     LocalPlayer & client = playerOfAvatar(avatar);
     DEBUG(client.toString());
 
-    actions.push_back(MahjongBegin(currentWind, roundWind, partWind == Wind(Wind::East)));
+    actions.push_back(MahjongBegin(gs.currentWind, gs.roundWind, gs.partWind == Wind(Wind::East)));
 
     return true;
 }
 
 bool GameData::clientSayGame(const Avatar & avatar, const ClientMessage & act, ActionList & actions)
 {
+    GameSession & gs = session();
+
     LocalPlayer & client = playerOfAvatar(avatar);
 
     // need fill winResult
-    if(client.isWinMahjong(currentWind, roundWind, dropStone, & winResult))
+    if(client.isWinMahjong(gs.currentWind, gs.roundWind, gs.dropStone, & gs.winResult))
     {
 	DEBUG(client.toString());
 
 	actions.push_back(MahjongSayGame(client.wind));
-	AI::mahjongOtherPass(currentWind, actions, client.wind);
+	AI::mahjongOtherPass(gs.currentWind, actions, client.wind);
 	return true;
     }
 
@@ -888,6 +1142,8 @@ bool GameData::clientSayGame(const Avatar & avatar, const ClientMessage & act, A
 
 bool GameData::clientSayChao(const Avatar & avatar, const ClientMessage & act, ActionList & actions)
 {
+    GameSession & gs = session();
+
     LocalPlayer & client = playerOfAvatar(avatar);
 
     DEBUG(client.toString());
@@ -898,10 +1154,10 @@ bool GameData::clientSayChao(const Avatar & avatar, const ClientMessage & act, A
 	return false;
     }
 
-    if(client.isMahjongChao(currentWind, dropStone))
+    if(client.isMahjongChao(gs.currentWind, gs.dropStone))
     {
 	actions.push_back(MahjongSayChao(client.wind));
-	AI::mahjongOtherPass(currentWind, actions, client.wind);
+	AI::mahjongOtherPass(gs.currentWind, actions, client.wind);
 	return true;
     }
 
@@ -911,6 +1167,8 @@ bool GameData::clientSayChao(const Avatar & avatar, const ClientMessage & act, A
 
 bool GameData::clientSayPung(const Avatar & avatar, const ClientMessage & act, ActionList & actions)
 {
+    GameSession & gs = session();
+
     LocalPlayer & client = playerOfAvatar(avatar);
 
     DEBUG(client.toString());
@@ -921,10 +1179,10 @@ bool GameData::clientSayPung(const Avatar & avatar, const ClientMessage & act, A
 	return false;
     }
 
-    if(client.isMahjongPung(currentWind, dropStone))
+    if(client.isMahjongPung(gs.currentWind, gs.dropStone))
     {
 	actions.push_back(MahjongSayPung(client.wind));
-	AI::mahjongOtherPass(currentWind, actions, client.wind);
+	AI::mahjongOtherPass(gs.currentWind, actions, client.wind);
 	return true;
     }
 
@@ -934,6 +1192,8 @@ bool GameData::clientSayPung(const Avatar & avatar, const ClientMessage & act, A
 
 bool GameData::clientSayKong(const Avatar & avatar, const ClientMessage & act, ActionList & actions)
 {
+    GameSession & gs = session();
+
     LocalPlayer & client = playerOfAvatar(avatar);
     auto action = static_cast<const ClientSayKong &>(act);
 
@@ -945,14 +1205,14 @@ bool GameData::clientSayKong(const Avatar & avatar, const ClientMessage & act, A
 	return false;
     }
 
-    if(1 == action.kongType() && client.isMahjongKong1(currentWind, dropStone))
+    if(1 == action.kongType() && client.isMahjongKong1(gs.currentWind, gs.dropStone))
     {
 	actions.push_back(MahjongSayKong(client.wind));
-	AI::mahjongOtherPass(currentWind, actions, client.wind);
+	AI::mahjongOtherPass(gs.currentWind, actions, client.wind);
 	return true;
     }
     else
-    if(2 == action.kongType() && client.isMahjongKong2(currentWind))
+    if(2 == action.kongType() && client.isMahjongKong2(gs.currentWind))
     {
 	actions.push_back(MahjongSayKong(client.wind));
 	return true;
@@ -964,19 +1224,21 @@ bool GameData::clientSayKong(const Avatar & avatar, const ClientMessage & act, A
 
 bool GameData::clientButtonGame(const Avatar & avatar, const ClientMessage & act, ActionList & actions)
 {
+    GameSession & gs = session();
+
     LocalPlayer & client = playerOfAvatar(avatar);
 
     DEBUG(client.toString());
 
-    client.setMahjongGame(winResult);
+    client.setMahjongGame(gs.winResult);
 
     actions.push_back(MahjongGame(client.wind));
-    AI::mahjongOtherPass(currentWind, actions, client.wind);
-    actions.push_back(MahjongData(currentWind));
+    AI::mahjongOtherPass(gs.currentWind, actions, client.wind);
+    actions.push_back(MahjongData(gs.currentWind));
 
-    actions.push_back(MahjongEnd(currentWind));
+    actions.push_back(MahjongEnd(gs.currentWind));
     validateMahjongSummary();
-    gamePart = Menu::MahjongSummaryPart;
+    gs.gamePart = Menu::MahjongSummaryPart;
 
     return true;
 }
@@ -987,23 +1249,32 @@ bool GameData::clientButtonPass(const Avatar & avatar, const ClientMessage & act
 
     DEBUG(client.toString());
 
-    if(AI::mahjongGameKongPungChao(currentWind, roundWind, dropStone, winResult, actions, false))
+    return mahjongPass(! client.isAI(), actions);
+}
+
+bool GameData::mahjongPass(bool shiftWind, ActionList & actions)
+{
+    GameSession & gs = session();
+
+    if(AI::mahjongGameKongPungChao(gs.currentWind, gs.roundWind, gs.dropStone, gs.winResult, actions, false))
 	return true;
 
-    if(! client.isAI())
+    if(shiftWind)
     {
-	currentWind.shift();
-	croupier.put(dropStone);
-	dropStone = Stone(Stone::None);
+	gs.currentWind.shift();
+	gs.croupier.put(gs.dropStone);
+	gs.dropStone = Stone(Stone::None);
     }
 
-    actions.push_back(MahjongData(currentWind));
-    skipRepeatSay = false;
+    actions.push_back(MahjongData(gs.currentWind));
+    gs.skipRepeatSay = false;
     return true;
 }
 
 bool GameData::clientButtonPung(const Avatar & avatar, const ClientMessage & act, ActionList & actions)
 {
+    GameSession & gs = session();
+
     LocalPlayer & client = playerOfAvatar(avatar);
 
     DEBUG(client.toString());
@@ -1014,96 +1285,121 @@ bool GameData::clientButtonPung(const Avatar & avatar, const ClientMessage & act
 	return false;
     }
 
-    actions.push_back(MahjongPung(client.wind, dropStone));
-    client.setMahjongPung(dropStone);
-    dropStone.reset();
-    currentWind = client.wind;
-    actions.push_back(MahjongData(currentWind));
-    skipNewStone = true;
+    actions.push_back(MahjongPung(client.wind, gs.dropStone));
+    size_t sets = client.rules.size();
+    client.setMahjongPung(gs.dropStone);
+    if(sets < client.rules.size())
+	gs.tiles.claim(client.rules.back(), gs.dropStone);
+    gs.dropStone.reset();
+    gs.currentWind = client.wind;
+    actions.push_back(MahjongData(gs.currentWind));
+    gs.skipNewStone = true;
 
     return true;
 }
 
 bool GameData::clientButtonKong1(const Avatar & avatar, const ClientMessage & act, ActionList & actions)
 {
+    GameSession & gs = session();
+
     LocalPlayer & client = playerOfAvatar(avatar);
 
     DEBUG(client.toString());
 
-    actions.push_back(MahjongKong1(client.wind, dropStone));
-    client.setMahjongKong1(dropStone);
-    dropStone.reset();
-    currentWind = client.wind;
-    actions.push_back(MahjongData(currentWind));
-    skipNewStone = true;
+    actions.push_back(MahjongKong1(client.wind, gs.dropStone));
+    size_t sets = client.rules.size();
+    client.setMahjongKong1(gs.dropStone);
+    if(sets < client.rules.size())
+	gs.tiles.claim(client.rules.back(), gs.dropStone);
+    gs.dropStone.reset();
+    gs.currentWind = client.wind;
+    actions.push_back(MahjongData(gs.currentWind));
+    gs.skipNewStone = true;
 
     return true;
 }
 
 bool GameData::clientButtonKong2(const Avatar & avatar, const ClientMessage & act, ActionList & actions)
 {
+    GameSession & gs = session();
+
     LocalPlayer & client = playerOfAvatar(avatar);
 
     DEBUG(client.toString());
 
     actions.push_back(MahjongKong2(client.wind));
+    const Stone stone = client.newStone;
+    size_t sets = client.rules.size();
     client.setMahjongKong2();
-    actions.push_back(MahjongData(currentWind));
+    // upgraded pung: one stone more on the table, a new concealed kong shows nothing
+    if(sets == client.rules.size() && ! client.newStone.isValid())
+	gs.tiles.upgradeKong(stone);
+    actions.push_back(MahjongData(gs.currentWind));
 
     return true;
 }
 
 bool GameData::clientChaoVariant(const Avatar & avatar, const ClientMessage & act, ActionList & actions)
 {
+    GameSession & gs = session();
+
     LocalPlayer & client = playerOfAvatar(avatar);
 
     auto ca = static_cast<const ClientChaoVariant &>(act);
 
     DEBUG(client.toString() << ", " << "variant: " << ca.chaoVariant());
 
-    actions.push_back(MahjongChao(client.wind, dropStone));
-    client.setMahjongChao(dropStone, ca.chaoVariant());
-    dropStone.reset();
-    currentWind = client.wind;
-    actions.push_back(MahjongData(currentWind));
-    skipNewStone = true;
+    actions.push_back(MahjongChao(client.wind, gs.dropStone));
+    size_t sets = client.rules.size();
+    client.setMahjongChao(gs.dropStone, ca.chaoVariant());
+    if(sets < client.rules.size())
+	gs.tiles.claim(client.rules.back(), gs.dropStone);
+    gs.dropStone.reset();
+    gs.currentWind = client.wind;
+    actions.push_back(MahjongData(gs.currentWind));
+    gs.skipNewStone = true;
 
     return true;
 }
 
 bool GameData::clientDropIndex(const Avatar & avatar, const ClientMessage & act, ActionList & actions)
 {
+    GameSession & gs = session();
+
     LocalPlayer & client = playerOfAvatar(avatar);
 
     auto ca = static_cast<const ClientDropIndex &>(act);
 
     DEBUG(client.toString() << ", " << "index: " << ca.dropIndex() << ", " << "stones: " << client.stones.toString());
     
-    if(dropStone.isValid())
+    if(gs.dropStone.isValid())
     {
-	ERROR("drop stone: " << dropStone() << ", " << "(" << dropStone.toString() << ")");
+	ERROR("drop stone: " << gs.dropStone() << ", " << "(" << gs.dropStone.toString() << ")");
 	return false;
     }
 
-    dropStone = client.setMahjongDrop(ca.dropIndex());
-    actions.push_back(MahjongDrop(currentWind, dropStone));
-    actions.push_back(MahjongData(currentWind));
+    gs.dropStone = client.setMahjongDrop(ca.dropIndex());
+    gs.tiles.drop(gs.currentWind, gs.dropStone);
+    actions.push_back(MahjongDrop(gs.currentWind, gs.dropStone));
+    actions.push_back(MahjongData(gs.currentWind));
 
-    DEBUG("drop stone: " << dropStone() << ", " << "(" << dropStone.toString() << ")");
+    DEBUG("drop stone: " << gs.dropStone() << ", " << "(" << gs.dropStone.toString() << ")");
 
-    AI::mahjongGameKongPungChao(currentWind, roundWind, dropStone, winResult, actions, true);
-    skipRepeatSay = true;
-    skipNewStone = false;
-    skipNewTurn = false;
+    AI::mahjongGameKongPungChao(gs.currentWind, gs.roundWind, gs.dropStone, gs.winResult, actions, true);
+    gs.skipRepeatSay = true;
+    gs.skipNewStone = false;
+    gs.skipNewTurn = false;
 
     return true;
 }
 
 bool GameData::clientSummonCreature(const Avatar & avatar, const ClientMessage & act, ActionList & actions)
 {
+    GameSession & gs = session();
+
     LocalPlayer & client = playerOfAvatar(avatar);
 
-    if(currentWind != client.wind)
+    if(gs.currentWind != client.wind)
     {
 	ERROR("wind not current: " << client.wind.toString());
 	return false;
@@ -1140,14 +1436,14 @@ bool GameData::clientSummonCreature(const Avatar & avatar, const ClientMessage &
 
     const LandInfo & landInfo = GameData::landInfo(land);
 
-    if(! landInfo.stat.power || (! land.isTowerWinds() && landInfo.clan != client.clan))
+    if(! landInfo.stat.power || (! land.isTowerWinds() && landClan(land) != client.clan))
     {
 	ERROR("land incorrect: " << land.toString());
 	return false;
     }
 
     const CreatureInfo & creatureInfo = GameData::creatureInfo(creature);
-    if(! client.stones.allowCast(creatureInfo.stones, client.newStone) && !ca.isForce())
+    if(! client.allowSummonRunes(creature) && !ca.isForce())
     {
 	ERROR("player can not cast rule: " << creatureInfo.stones.toString());
 	return false;
@@ -1175,8 +1471,8 @@ bool GameData::clientSummonCreature(const Avatar & avatar, const ClientMessage &
 	client.setCasted(true);
     }
 
-    actions.push_back(MahjongSummon(currentWind, creature, land));
-    actions.push_back(MahjongData(currentWind));
+    actions.push_back(MahjongSummon(gs.currentWind, creature, land));
+    actions.push_back(MahjongData(gs.currentWind));
 
     DEBUG(client.toString() << ", " << "creature: " << creature.toString() << ", " << "land: " << land.toString());
     return true;
@@ -1184,9 +1480,11 @@ bool GameData::clientSummonCreature(const Avatar & avatar, const ClientMessage &
 
 bool GameData::clientCastSpell(const Avatar & avatar, const ClientMessage & act, ActionList & actions)
 {
+    GameSession & gs = session();
+
     LocalPlayer & client = playerOfAvatar(avatar);
 
-    if(currentWind != client.wind)
+    if(gs.currentWind != client.wind)
     {
 	ERROR("wind not current: " << client.wind.toString());
 	return false;
@@ -1232,7 +1530,7 @@ bool GameData::clientCastSpell(const Avatar & avatar, const ClientMessage & act,
     {
 	DEBUG(client.toString() << ", " << "spell: " << spell.toString());
 
-	actions.push_back(MahjongCast(currentWind, spell));
+	actions.push_back(MahjongCast(gs.currentWind, spell));
 	client.mahjongApplySpell(spell);
     }
     else
@@ -1241,7 +1539,7 @@ bool GameData::clientCastSpell(const Avatar & avatar, const ClientMessage & act,
 	Avatar target = ca.target();
 	DEBUG(client.toString() << ", " << "spell: " << spell.toString() << ", " << "target: " << target.toString());
 
-	actions.push_back(MahjongCast(currentWind, spell, target));
+	actions.push_back(MahjongCast(gs.currentWind, spell, target));
 	playerOfAvatar(target).mahjongApplySpell(spell);
     }
     else
@@ -1257,7 +1555,7 @@ bool GameData::clientCastSpell(const Avatar & avatar, const ClientMessage & act,
 
 	if(spellInfo.target() == SpellTarget::Land)
 	{
-	    for(auto & lp : gamers)
+	    for(auto & lp : gs.gamers)
 	    {
 		auto party = lp.army.findPartyConst(land);
 		if(party) targets << BattleTargets(party->toBattleCreatures());
@@ -1274,7 +1572,7 @@ bool GameData::clientCastSpell(const Avatar & avatar, const ClientMessage & act,
 	    else
 	    if(spellInfo.target() & SpellTarget::Enemy)
 	    {
-		for(auto & lp : gamers)
+		for(auto & lp : gs.gamers)
 		{
 	    	    if(client.clan != lp.clan)
 		    {
@@ -1301,7 +1599,7 @@ bool GameData::clientCastSpell(const Avatar & avatar, const ClientMessage & act,
 		resistence.push_back(tgt->battleUnit());
 	}
 
-	actions.push_back(MahjongCast(currentWind, spell, land, targets, resistence));
+	actions.push_back(MahjongCast(gs.currentWind, spell, land, targets, resistence));
 	std::set<Clan> checkArmy;
 
 	// check dead creatures
@@ -1311,7 +1609,7 @@ bool GameData::clientCastSpell(const Avatar & avatar, const ClientMessage & act,
 	    {
 		const LocalPlayer & other = playerOfClan(tgt->clan());
 		const std::string & info = StringFormat("%1's %2 vas vanquished").arg(other.name()).arg(tgt->name());
-		actions.push_back(MahjongInfo(currentWind, info));
+		actions.push_back(MahjongInfo(gs.currentWind, info));
 		checkArmy.insert(tgt->clan());
 	    }
 	}
@@ -1332,7 +1630,7 @@ bool GameData::clientCastSpell(const Avatar & avatar, const ClientMessage & act,
     client.setCasted(true);
 
     // copy all data
-    actions.push_back(MahjongData(currentWind));
+    actions.push_back(MahjongData(gs.currentWind));
     return true;
 }
 
@@ -1363,6 +1661,8 @@ bool GameData::client2Mahjong(const Avatar & avatar, const ClientMessage & act,
 
 void GameData::validateMahjongSummary(void)
 {
+    GameSession & gs = session();
+
     int total = 0;
 
     for(auto & id : winds_all)
@@ -1382,80 +1682,85 @@ void GameData::validateMahjongSummary(void)
 	}
     }
 
-    if(dropStone.isValid())
+    if(gs.dropStone.isValid())
     {
-	DEBUG("drop stone: " << dropStone());
+	DEBUG("drop stone: " << gs.dropStone());
 	total += 1;
     }
 
-    DEBUG("croupier trash: " << croupier.trash.toString());
-    DEBUG("croupier bank: " << croupier.bank.toString());
-    total += croupier.trash.size() + croupier.bank.size();
+    DEBUG("croupier trash: " << gs.croupier.trash.toString());
+    DEBUG("croupier bank: " << gs.croupier.bank.toString());
+    total += gs.croupier.trash.size() + gs.croupier.bank.size();
 
     DEBUG("game total: " << total << ", " << "(" << (total != 136 ? "FALSE" : "TRUE") << ")");
 }
 
-namespace Battle
-{
-    BattleStrike	applyRangerAttack(const BattleUnit &, BattleCreature &);
-    BattleStrike	applyMeleeAttack(BattleUnit &, BattleUnit &, int bonus);
-    BattleStrikes	rangersAttack(const BattleCreatures &, BattleParty &);
-    BattleStrikes	meleeAttack(BattleUnit &, BattleParty &);
-    BattleStrikes	meleesAttack(BattleCreatures, BattleParty &);
-    BattleStrikes	doAttackParty(BattleParty &, BattleTown &, BattleParty*);
-    int			calculateDamage(const BattleUnit &, const BattleUnit &, int bonus);
-}
-
 bool GameData::initAdventure(void)
 {
-    VERBOSE("wind round: " << roundWind.toString());
-    VERBOSE("wind part: " << partWind.toString());
+    GameSession & gs = session();
+
+    VERBOSE("wind round: " << gs.roundWind.toString());
+    VERBOSE("wind part: " << gs.partWind.toString());
 
-    gamePart = Menu::AdventurePart;
-    currentWind = Wind(Wind::East);
+    gs.gamePart = Menu::AdventurePart;
+    gs.currentWind = Wind(Wind::East);
+    gs.aiMoves.reset();
 
-    for(auto & lp : gamers)
+    for(auto & lp : gs.gamers)
 	lp.initAdventurePart();
 
-    skipRepeatSay = false;
+    gs.skipRepeatSay = false;
     return true;
 }
 
 bool GameData::adventure2Client(const Avatar & avatar, ActionList & actions)
 {
-    const LocalPlayer & player = GameData::playerOfWind(currentWind);
+    GameSession & gs = session();
+
+    const LocalPlayer & player = GameData::playerOfWind(gs.currentWind);
 
     if(player.adventurePartDone())
     {
-	if(gamePart == Menu::AdventurePart)
+	if(gs.gamePart == Menu::AdventurePart)
 	{
-	    adventureBattleAction(avatar, actions);
-	    if(currentWind() == Wind::North) gamePart = Menu::BattleSummaryPart;
-	    currentWind.shift();
+	    adventureBattleAction(player.avatar, actions);
+	    if(gs.currentWind() == Wind::North) gs.gamePart = Menu::BattleSummaryPart;
+	    gs.currentWind.shift();
 	}
 	else
 	{
-	    actions.push_back(AdventureEnd(currentWind));
+	    actions.push_back(AdventureEnd(gs.currentWind));
 	    return true;
 	}
     }
     else
     {
-	// DEBUG("wind: " << currentWind.toString() << ", " << "person: " << player.name());
+	// DEBUG("wind: " << gs.currentWind.toString() << ", " << "person: " << player.name());
 
 	if(player.isAI())
 	{
-	    actions.push_back(AdventureTurn(currentWind));
-	    AI::adventureMove(player, actions);
+	    if(gs.aiMoves)
+	    {
+		if(! AI::adventurePendingMoves(actions))
+		    return false;
+	    }
+	    else
+	    {
+		actions.push_back(AdventureTurn(gs.currentWind));
+
+		if(! AI::adventureMove(player, actions))
+		    return true;
+	    }
+
 	    client2Adventure(player.avatar, ClientBattleReady(), actions);
 	}
 	else
 	{
-	    if(skipRepeatSay)
+	    if(gs.skipRepeatSay)
 		return false;
 
-	    actions.push_back(AdventureTurn(currentWind));
-	    skipRepeatSay = true;
+	    actions.push_back(AdventureTurn(gs.currentWind));
+	    gs.skipRepeatSay = true;
 	}
     }
 
@@ -1494,7 +1799,7 @@ bool GameData::clientUnitMoved(const Avatar & avatar, const ClientMessage & act,
 
     if(client.army.moveCreature(*bcr, land))
     {
-	actions.push_back(AdventureMoves(currentWind, unit, land));
+	actions.push_back(AdventureMoves(session().currentWind, unit, land));
 	return true;
     }
 
@@ -1514,17 +1819,22 @@ bool GameData::clientBattleReady(const Avatar & avatar, const ClientMessage & ac
 
 bool GameData::adventureBattleAction(const Avatar & avatar, ActionList & actions)
 {
+    GameSession & gs = session();
+
     LocalPlayer & player = playerOfAvatar(avatar);
 
-    for(auto it = player.army.begin(); it != player.army.end(); ++it)
+    std::vector<Battle::Combat> combats;
+    std::vector<BattleLegend> legends;
+
+    // collect: one combat by enemy land, streams seeded in army order
+    for(auto & party : player.army)
     {
-	const Land & land = (*it).land();
+	const Land & land = party.land();
 
 	// skip public zone
 	if(land.isTowerWinds()) continue;
 
-	LandInfo & landInfo = landsInfo[land()];
-	LocalPlayer & other = playerOfClan(landInfo.clan);
+	LocalPlayer & other = playerOfClan(landClan(land));
 
 	// all armies moved to dest: need check clan
 	if(player.clan != other.clan)
@@ -1532,40 +1842,47 @@ bool GameData::adventureBattleAction(const Avatar & avatar, ActionList & actions
 	    BattleParty* defenders = other.army.findParty(land);
 	    BattleTown town = BattleTown(land);
 
-	    DEBUG("attacker " << (*it).toString());
+	    DEBUG("attacker " << party.toString());
 	    DEBUG("defender tower: " << town.toString());
 	    DEBUG("defender " << (defenders ? defenders->toString() : "party: empty"));
 
-	    BattleLegend legend(player.avatar, *it, other.avatar, (defenders ? *defenders : BattleParty()), town, false);
+	    legends.emplace_back(player.avatar, party, other.avatar, (defenders ? *defenders : BattleParty()), town, false);
+	    combats.emplace_back(& party, defenders, town, gs.randomGen());
+	}
+    }
 
-	    // doAttackParty: modify BattleParties
-	    const BattleStrikes strikes = Battle::doAttackParty(*it, town, defenders);
+    // resolve: modify BattleParties
+    Battle::resolveCombats(combats);
 
-	    // wins?
-	    if(! town.isAlive())
-	    {
-		DEBUG("battle wins");
-		if(defenders)
-		{
-		    defenders->dismiss();
-		    other.army.shrinkEmpty();
-		}
-		legend.wins = true;
-		landInfo.clan = player.clan;
-	    }
-	    else
-	    {
-		DEBUG("battle loose");
-		(*it).dismiss();
-	    }
+    // apply: army order
+    for(size_t it = 0; it < combats.size(); ++it)
+    {
+	Battle::Combat & combat = combats[it];
+	BattleLegend & legend = legends[it];
 
-	    DEBUG("legend: " << legend.toString());
-	    actions.push_back(AdventureCombat(currentWind, legend, strikes));
-	    battleHistory.push_back(legend);
+	// wins?
+	if(! combat.town.isAlive())
+	{
+	    DEBUG("battle wins");
+	    if(combat.defenders)
+		combat.defenders->dismiss();
+	    legend.wins = true;
+	    setLandClan(combat.town.land(), player.clan);
 	}
+	else
+	{
+	    DEBUG("battle loose");
+	    combat.attackers->dismiss();
+	}
+
+	DEBUG("legend: " << legend.toString());
+	actions.push_back(AdventureCombat(gs.currentWind, legend, combat.strikes));
+	gs.battleHistory.push_back(legend);
     }
 
-    player.army.shrinkEmpty();
+    // after apply: parties of later combats still referenced above
+    for(auto & lp : gs.gamers)
+	lp.army.shrinkEmpty();
 
     return true;
 }
@@ -25,8 +25,19 @@
 
 #include <list>
 #include <array>
+#include <memory>
+#include <random>
 
 #include "actions.h"
+#include "scoretable.h"
+
+class LandMap;
+
+namespace AI
+{
+    struct PendingDrop;
+    struct PendingMoves;
+}
 
 namespace Menu
 {
@@ -118,6 +129,7 @@ struct CreatureInfo
     std::string			description;
     std::string 		sound1;
     Stones			stones;
+    RuneCounts			runes;
 
     CreatureInfo() : unique(false), fly(false), cost(0) {}
 };
@@ -131,6 +143,7 @@ struct SpellInfo
     std::string 		description;
     std::string 		sound;
     Stones			stones;
+    RuneCounts			runes;
     BaseStat			effect;
     bool         		persistent;
     int				cost;
@@ -173,7 +186,7 @@ struct AvatarInfo
 struct LandInfo
 {
     Land			id;
-    Clan			clan;
+    Clan			clan; // start owner, current: GameData::landClan
     TownStat			stat;
     Point			center;
     Rect			area;
@@ -222,9 +235,42 @@ struct ActionList : std::list<ActionMessage>
 {
 };
 
+/* mutable state of one game, catalogs are shared and read only */
+struct GameSession
+{
+    std::mt19937		randomGen;
+
+    Person			person;
+    LocalPlayers		gamers;
+    Wind			currentWind;
+    Wind			roundWind;
+    Wind			partWind;
+    CroupierSet			croupier;
+    TileTracker			tiles;
+    int				stoneLastCount;
+    Stone			dropStone;
+    WinResults			winResult;
+    std::list<BattleLegend>	battleHistory;
+    bool			skipRepeatSay;
+    bool			skipNewStone;
+    bool			skipNewTurn;
+    int				gamePart;
+    int				battleUnitId;
+    JsonObject			stateGUI;
+    std::shared_ptr<AI::PendingDrop> aiSearch;
+    std::shared_ptr<AI::PendingMoves> aiMoves;
+
+    LandOwners			landsClan;
+    std::array<ClanLands, Clan::Purple + 1> clanLands; // by clan id, kept with landsClan
+
+    GameSession() : randomGen(std::random_device()()), stoneLastCount(0), skipRepeatSay(false),
+	skipNewStone(false), skipNewTurn(false), gamePart(0), battleUnitId(1) {}
+};
+
 namespace GameData
 {
-    bool			init(const JsonObject &);
+    /* compiled: false, jsons only (asset compilers) */
+    bool			init(const JsonObject &, bool compiled = true);
 
     LocalData                   toLocalData(const Avatar &);
 
@@ -233,15 +279,28 @@ namespace GameData
     const StoneInfo &		stoneInfo(const Stone &);
     const WindInfo &		windInfo(const Wind &);
     const LandInfo &		landInfo(const Land &);
+    const LandMap &		landMap(void);
+    bool			compileLandMap(std::vector<uint8_t> &);
+    bool			compileCatalog(std::vector<uint8_t> &);
     const AvatarInfo &		avatarInfo(const Avatar &);
     const ClanInfo &		clanInfo(const Clan &);
     const AbilityInfo &		abilityInfo(const Ability &);
     const SpecialityInfo &	specialityInfo(const Speciality &);
     const CreatureInfo &	creatureInfo(const Creature &);
     const SpellInfo &		spellInfo(const Spell &);
+    const ScoreTable &		scoreTable(void);
     Avatars			avatarsOfClan(const Clan &);
 
-    void			initPersons(const Person &);
+    /* current session of this thread, default: main session */
+    GameSession &		session(void);
+    void			setSession(GameSession*);
+
+    Clan			landClan(const Land &);
+    void			setLandClan(const Land &, const Clan &);
+    const LandOwners &		landOwners(void);
+    const ClanLands &		clanLands(const Clan &);
+
+    void			initPersons(const Person &, bool allAI = false);
 
     bool			initMahjong(void);
     bool			mahjong2Client(const Avatar &, ActionList &);
@@ -270,6 +329,18 @@ namespace GameData
     RemotePlayer*		getBattleArmyOwner(const BattleArmy &);
     BattleArmy &		getBattleArmy(const Clan &);
     std::list<BattleLegend>	getBattleHistoryFor(const Avatar &);
+
+    std::mt19937 &		randomEngine(void);
+    void			setRandomSeed(unsigned int);
+    int				random(int min, int max);
+
+    template<typename Iter>
+    Iter			randomIterator(Iter it1, Iter it2)
+    {
+	auto dist = std::distance(it1, it2);
+	if(0 < dist) std::advance(it1, random(0, dist - 1));
+	return it1;
+    }
 };
 
 #endif
@@ -32,6 +32,11 @@
 
 std::initializer_list<Clan::clan_t> clans_all = { Clan::Red, Clan::Yellow, Clan::Aqua, Clan::Purple };
 std::initializer_list<Wind::wind_t> winds_all = { Wind::East, Wind::South, Wind::West, Wind::North };
+std::initializer_list<Stone::stone_t> stones_all = { Stone::Skull1, Stone::Skull2, Stone::Skull3, Stone::Skull4, Stone::Skull5, Stone::Skull6, Stone::Skull7, Stone::Skull8, Stone::Skull9,
+		    Stone::Sword1, Stone::Sword2, Stone::Sword3, Stone::Sword4, Stone::Sword5, Stone::Sword6, Stone::Sword7, Stone::Sword8, Stone::Sword9,
+		    Stone::Number1, Stone::Number2, Stone::Number3, Stone::Number4, Stone::Number5, Stone::Number6, Stone::Number7, Stone::Number8, Stone::Number9,
+		    Stone::Wind1, Stone::Wind2, Stone::Wind3, Stone::Wind4,
+		    Stone::Dragon1, Stone::Dragon2, Stone::Dragon3 };
 std::initializer_list<Land::land_t> lands_all = { Land::TowerOf4Winds, Land::Maithaius, Land::Baliphon, Land::Vermille, Land::Sulanthia,
 		Land::Trojensek, Land::Talon, Land::Siramak, Land::Ronzinol, Land::Corzen, Land::Greenbaw, Land::Zubrus, Land::Corimar,
 		Land::Inkartha, Land::Hexan, Land::Firland, Land::Vesna, Land::Kern, Land::RegencyPeaks, Land::Knighthaven, Land::Rikter, Land::Gorok,
@@ -177,7 +182,7 @@ std::string Clan::toString(void) const
 
 Clan Clan::random(void)
 {
-    auto res = Tools::random_n(clans_all.begin(), clans_all.end());
+    auto res = GameData::randomIterator(clans_all.begin(), clans_all.end());
     return *res;
 }
 
@@ -392,7 +397,7 @@ std::string Avatar::toString(void) const
 
 Avatar Avatar::random(void)
 {
-    switch(Tools::rand(1, 9))
+    switch(GameData::random(1, 9))
     {
 	case 1: return Orachi;
 	case 2:	return Lakkho;
@@ -556,15 +561,7 @@ Lands Lands::powerOnly(void) const
 
 Lands Lands::thisClan(const Clan & clan)
 {
-    Lands res;
-
-    for(auto & id : lands_all)
-    {
-	const LandInfo & info = GameData::landInfo(id);
-	if(info.clan == clan) res << info.id;
-    }
-
-    return res;
+    return GameData::clanLands(clan).toLands();
 }
 
 Lands Lands::enemyAroundOnly(const Clan & clan)
@@ -578,10 +575,7 @@ Lands Lands::enemyAroundOnly(const Clan & clan)
 	const auto & aroundLands = info1.borders;
 
 	for(auto it2 = aroundLands.begin(); it2 != aroundLands.end(); ++it2)
-	{
-	    const LandInfo & info2 = GameData::landInfo(*it2);
-	    if(info2.clan != clan) enemyLands << info2.id;
-	}
+	    if(GameData::landClan(*it2) != clan) enemyLands << *it2;
     }
 
     std::sort(enemyLands.begin(), enemyLands.end());
@@ -590,6 +584,73 @@ Lands Lands::enemyAroundOnly(const Clan & clan)
     return enemyLands;
 }
 
+/* LandOwners */
+Lands LandOwners::thisClan(const Clan & clan) const
+{
+    Lands res;
+
+    for(auto & id : lands_all)
+	if((*this)[id] == clan()) res << Land(id);
+
+    return res;
+}
+
+/* ClanLands */
+void ClanLands::add(const Land & land)
+{
+    if(land.isValid() && ! isOwned(land))
+    {
+	const TownStat & stat = GameData::landInfo(land).stat;
+
+	mask |= 1ULL << land();
+	count += 1;
+	points += stat.point;
+	if(stat.power) powers += 1;
+    }
+}
+
+void ClanLands::remove(const Land & land)
+{
+    if(land.isValid() && isOwned(land))
+    {
+	const TownStat & stat = GameData::landInfo(land).stat;
+
+	mask &= ~(1ULL << land());
+	count -= 1;
+	points -= stat.point;
+	if(stat.power) powers -= 1;
+    }
+}
+
+Lands ClanLands::toLands(void) const
+{
+    Lands res;
+
+    for(int id = 0; id <= Land::SiphonsChute; ++id)
+	if(mask & (1ULL << id)) res << Land(static_cast<Land::land_t>(id));
+
+    return res;
+}
+
+JsonArray LandOwners::toJsonArray(void) const
+{
+    JsonArray ja;
+    for(auto & id : *this)
+	ja.addString(Clan(static_cast<Clan::clan_t>(id)).toString());
+    return ja;
+}
+
+LandOwners LandOwners::fromJsonArray(const JsonArray & ja)
+{
+    LandOwners res;
+    for(int it = 0; it < ja.size() && it < res.size(); ++it)
+    {
+	const JsonValue* jv = ja.getValue(it);
+	if(jv) res[it] = Clan(jv->getString())();
+    }
+    return res;
+}
+
 struct LandCost
 {
     Land	owner;
@@ -1112,7 +1173,7 @@ GameStones GameStones::fromJsonArray(const JsonArray & ja)
     for(int it = 0; it < ja.size(); ++it)
     {
 	const JsonObject* jo =ja.getObject(it);
-	if(jo) res.push_back(GameStone::fromJsonObject(*jo));
+	if(jo) res.add(GameStone::fromJsonObject(*jo));
     }
     return res;
 }
@@ -1225,8 +1286,8 @@ void GameStones::add(const GameStone & stone)
 {
     if(!stone.isValid())
 	ERROR("invalid stone");
-    push_back(stone);
-    std::sort(begin(), end());
+    insert(std::upper_bound(begin(), end(), stone), stone);
+    counts.add(stone);
 }
 
 Stone GameStones::del(int index)
@@ -1236,8 +1297,32 @@ Stone GameStones::del(int index)
     {
 	res = at(index);
 	erase(begin() + index);
-	std::sort(begin(), end());
+	counts[res()]--;
+    }
+    return res;
+}
+
+void GameStones::clear(void)
+{
+    Stones::clear();
+    counts.fill(0);
+}
+
+Stones GameStones::findPairs(void) const
+{
+    Stones res;
+
+    for(int id = Stone::Skull1; id <= Stone::Dragon3; ++id)
+    {
+	const Stone stone(static_cast<Stone::stone_t>(id));
+
+        if(2 == counts[id] || 3 == counts[id])
+            res << stone;
+        else
+	if(4 == counts[id])
+            res << stone << stone;
     }
+
     return res;
 }
 
@@ -1265,33 +1350,33 @@ void GameStones::remove(const WinRule & rule)
 	case WinRule::Chao:
 	    if(! rule.stone().isSpecial())
 	    {
-		auto itend = std::remove_if(begin(), end(),
-				    [&](const Stone & st){ return st == rule.stone().next() || st == rule.stone().next().next(); });
+		const Stone stone1 = rule.stone().next();
+		const Stone stone2 = stone1.next();
+		auto itend = std::remove_if(Stones::begin(), Stones::end(),
+				    [&](const Stone & st){ return st == stone1 || st == stone2; });
 		if(itend != end())
+		{
 		    erase(itend, end());
+		    counts[stone1()] = 0;
+		    counts[stone2()] = 0;
+		}
 		else
 		    ERROR("chao not found: " << rule.stone().id());
 	    }
 	    break;
 	case WinRule::Pung:
-	    for(int ii = 1; ii <= 3; ++ii)
-	    {
-		auto it = std::find(begin(), end(), rule.stone());
-		if(it != end())
-		    erase(it);
-		else
-		    ERROR("pung not found: " << rule.stone().id());
-	    }
-	    break;
 	case WinRule::Kong:
-	    for(int ii = 1; ii <= 4; ++ii)
-	    {
-		auto it = std::find(begin(), end(), rule.stone());
-		if(it != end())
-		    erase(it);
-		else
-		    ERROR("kong not found: " << rule.stone().id());
-	    }
+	{
+	    const int need = rule.count();
+	    const int found = std::min(need, countStone(rule.stone()));
+	    auto it = std::lower_bound(begin(), end(), rule.stone());
+
+	    erase(it, it + found);
+	    counts[rule.stone()()] -= found;
+
+	    if(found < need)
+		ERROR((rule.isKong() ? "kong" : "pung") << " not found: " << rule.stone().id());
+	}
 	    break;
 	default: break;
     }
@@ -1309,23 +1394,42 @@ std::string GameStones::toString(void) const
     return os.str();
 }
 
-bool GameStones::allowCast(const Stones & rules) const
+/* RuneCounts */
+RuneCounts::RuneCounts(const Stones & stones)
 {
-    if(! rules.size())
-	return true;
+    fill(0);
 
-    GameStones stones = *this;
-    stones.resize(std::distance(stones.begin(), std::remove_if(stones.begin(), stones.end(), [](auto & st){ return GameStone::isCasted(st); })));
+    for(auto & st : stones)
+	add(st);
+}
 
-    Stones uniq = rules.toUnique();
+bool RuneCounts::contains(const RuneCounts & need) const
+{
+    // without branches: vectorized compare
+    uint8_t fail = 0;
 
-    for(auto it = uniq.begin(); it != uniq.end(); ++it)
-    {
-	if(rules.countStone(*it) > stones.countStone(*it))
-	    return false;
-    }
+    for(size_t it = 0; it < size(); ++it)
+	fail |= (*this)[it] < need[it];
 
-    return true;
+    return ! fail;
+}
+
+RuneCounts GameStones::uncastedCounts(const GameStone & newStone) const
+{
+    RuneCounts res;
+
+    for(auto & st : *this)
+	if(! GameStone::isCasted(st)) res.add(st);
+
+    if(newStone.isValid() && ! newStone.isCasted())
+	res.add(newStone);
+
+    return res;
+}
+
+bool GameStones::allowCast(const Stones & rules) const
+{
+    return allowCast(RuneCounts(rules), GameStone());
 }
 
 bool GameStones::allowCast(const Stones & rules, const GameStone & newStone) const
@@ -1334,22 +1438,23 @@ bool GameStones::allowCast(const Stones & rules, const GameStone & newStone) con
     if(! rules.size())
 	return true;
 
-    if(newStone.isValid())
-    {
-	GameStones stones = *this;
-	stones.add(newStone);
-	return stones.allowCast(rules);
-    }
+    return allowCast(RuneCounts(rules), newStone);
+}
 
-    return allowCast(rules);
+bool GameStones::allowCast(const RuneCounts & runes, const GameStone & newStone) const
+{
+    return uncastedCounts(newStone).contains(runes);
 }
 
 void GameStones::setCasted(const Stones & rules, GameStone & newStone)
 {
+    auto less = [](const Stone & st1, const Stone & st2){ return GameStone(st1) < GameStone(st2); };
+
     for(auto it1 = rules.begin(); it1 != rules.end(); ++it1)
     {
-	auto it2 = std::find(begin(), end(), GameStone(*it1, false));
-	if(it2 != end())
+	// first uncasted: casted of same id sorted before, order kept
+	auto it2 = std::lower_bound(Stones::begin(), Stones::end(), GameStone(*it1, false), less);
+	if(it2 != Stones::end() && *it2 == *it1 && ! GameStone::isCasted(*it2))
 	    static_cast<GameStone &>(*it2).setCasted(true);
 	else
 	if(newStone.isValid() && ! newStone.isCasted() && newStone == *it1)
@@ -1786,7 +1891,7 @@ bool BattleCreature::applySpell(const Spell & spell)
     {
     	int chance = SpecialityMagicResistence().chance(Creature::id());
 
-	if(chance > Tools::rand(1, 100))
+	if(chance > GameData::random(1, 100))
 	{
 	    VERBOSE("Speciality: " << "Magic Resistence!");
 	    return false;
@@ -1816,7 +1921,7 @@ bool BattleCreature::applySpell(const Spell & spell)
 
 	case Spell::MysticalFountain:
 	{
-	    auto rnd = static_cast<Spell::spell_t>(Spell::MysticalFountain + Tools::rand(1, 3));
+	    auto rnd = static_cast<Spell::spell_t>(Spell::MysticalFountain + GameData::random(1, 3));
 	    affected.insert(Spell(rnd));
 	}
 	    return true;
@@ -1968,7 +2073,7 @@ BattleTargets BattleTargets::fromJsonArray(const JsonArray & ja)
 /* BattleTown */
 BattleTown::BattleTown(const Land & land) : BattleUnit(GameData::landInfo(land).stat), territory(land)
 {
-    previous = GameData::landInfo(land).clan;
+    previous = GameData::landClan(land);
 }
 
 JsonObject BattleTown::toJsonObject(void) const
@@ -1994,9 +2099,9 @@ const Clan & BattleTown::previousClan(void) const
     return previous;
 }
 
-const Clan & BattleTown::currentClan(void) const
+Clan BattleTown::currentClan(void) const
 {
-    return GameData::landInfo(land()).clan;
+    return GameData::landClan(land());
 }
 
 std::string BattleTown::toString(void) const
@@ -2016,7 +2121,6 @@ std::string BattleTown::name(void) const
 /* BattleParty */
 BattleParty::BattleParty(const Clan & clan, const Land & land) : position(land), target(Land::None), owner(clan)
 {
-    resize(3);
 }
 
 std::string BattleParty::toString(void) const
@@ -2065,9 +2169,7 @@ BattleParty BattleParty::fromJsonObject(const JsonObject & jo)
     const JsonArray* ja = jo.getArray("creatures");
     if(ja)
     {
-	res.resize(ja->size());
-
-	for(int it = 0; it < ja->size(); ++it)
+	for(int it = 0; it < ja->size() && it < static_cast<int>(res.size()); ++it)
 	{
 	    const JsonObject* jo = ja->getObject(it);
 	    if(jo && jo->isValid())
@@ -2141,7 +2243,7 @@ bool BattleParty::isEmpty(void) const
 
 void BattleParty::dismiss(void)
 {
-    clear();
+    fill(BattleCreature());
 }
 
 bool BattleParty::canJoin(void) const
@@ -2161,6 +2263,16 @@ bool BattleParty::join(const Creature & cr)
     return true;
 }
 
+bool BattleParty::join(const BattleCreature & bcr)
+{
+    // moved creature: keep unit id, skill and spells
+    auto it = std::find_if(begin(), end(), [](const BattleCreature & slot){ return ! slot.isValid(); });
+    if(it == end()){ ERROR("party: is full"); return false; }
+
+    *it = bcr;
+    return true;
+}
+
 bool BattleParty::remove(const BattleCreature & bcr)
 {
     auto it = std::find(begin(), end(), bcr);
@@ -2179,6 +2291,22 @@ void BattleParty::removeUnloyalty(void)
 	*it = BattleCreature();
 }
 
+bool BattleParty::findSpeciality(const Speciality & spec) const
+{
+    return std::any_of(begin(), end(),
+		[&](const BattleCreature & bcr){ return bcr.isValid() && GameData::creatureInfo(bcr).specials.check(spec); });
+}
+
+void BattleParty::removeSpeciality(const Speciality & spec)
+{
+    for(auto it = begin(); it != end(); ++it)
+	if((*it).isValid() && GameData::creatureInfo(*it).specials.check(spec))
+    {
+	DEBUG("remove " << spec.toString() << ", " << "land: " << position.toString() << ", " << "creature: " << (*it).toString());
+	*it = BattleCreature();
+    }
+}
+
 const BattleCreature* BattleParty::index(int index) const
 {
     return 0 <= index && index < size() ? & at(index) : nullptr;
@@ -2226,6 +2354,68 @@ BaseStat BattleParty::toBaseStatSummary(void) const
 }
 
 /*BattleArmy */
+BattleArmy & BattleArmy::operator= (const BattleArmy & army)
+{
+    std::list<BattleParty>::operator=(army);
+    units.clear();
+    unitsValid = false;
+    return *this;
+}
+
+void BattleArmy::rebuildUnits(void) const
+{
+    units.clear();
+    lands.fill(nullptr);
+
+    for(auto & party : *this)
+    {
+	// one party by land, first wins as find_if did
+	if(party.land().isValid() && ! lands[party.land().id()])
+	    lands[party.land().id()] = const_cast<BattleParty*>(& party);
+
+	for(int slot = 0; party.index(slot); ++slot)
+	{
+	    const int uid = party.index(slot)->battleUnit();
+
+	    if(0 < uid)
+	    {
+		if(units.size() <= static_cast<size_t>(uid))
+		    units.resize(uid + 1);
+
+		units[uid] = UnitSlot(const_cast<BattleParty*>(& party), slot);
+	    }
+	}
+    }
+
+    unitsValid = true;
+}
+
+const BattleArmy::UnitSlot* BattleArmy::findUnitSlot(int uid) const
+{
+    if(! unitsValid)
+	rebuildUnits();
+
+    if(0 < uid && static_cast<size_t>(uid) < units.size())
+    {
+	const UnitSlot & res = units[uid];
+
+	// removed by party: dismiss, battle losses
+	if(res.party)
+	{
+	    const BattleCreature* bcr = res.party->index(res.slot);
+	    if(bcr && bcr->isBattleUnit(uid)) return & res;
+	}
+    }
+
+    return nullptr;
+}
+
+BattleParty* BattleArmy::findPartyOfUnit(int uid)
+{
+    const UnitSlot* us = findUnitSlot(uid);
+    return us ? us->party : nullptr;
+}
+
 BattleParty* BattleArmy::findParty(const Land & land)
 {
     return const_cast<BattleParty*>(findPartyConst(land));
@@ -2233,8 +2423,10 @@ BattleParty* BattleArmy::findParty(const Land & land)
 
 const BattleParty* BattleArmy::findPartyConst(const Land & land) const
 {
-    auto it = std::find_if(begin(), end(), [&](const BattleParty & party){ return party.isPosition(land); });
-    return it != end() ? & (*it) : nullptr;
+    if(! unitsValid)
+	rebuildUnits();
+
+    return land.isValid() && land.id() < static_cast<int>(lands.size()) ? lands[land.id()] : nullptr;
 }
 
 BattleCreatures BattleArmy::partySelected(const Land & land) const
@@ -2267,12 +2459,8 @@ BattleCreature* BattleArmy::findBattleUnit(int uid)
 
 const BattleCreature* BattleArmy::findBattleUnitConst(int uid) const
 {
-    for(auto & party : *this)
-    {
-	const BattleCreature* res = party.findBattleUnitConst(uid);
-	if(res) return res;
-    }
-    return nullptr;
+    const UnitSlot* us = findUnitSlot(uid);
+    return us ? us->party->index(us->slot) : nullptr;
 }
 
 bool BattleArmy::findCreature(const Creature & cr) const
@@ -2337,14 +2525,19 @@ void BattleArmy::setAllSelected(void)
 	if(*it) (*it)->setSelected(true);
 }
 
-bool BattleArmy::isFullHouse(void) const
+int BattleArmy::count(void) const
 {
-    int count = 0;
+    int res = 0;
 
     for(auto it = begin(); it != end(); ++it)
-	count += (*it).count();
+	res += (*it).count();
+
+    return res;
+}
 
-    return count >= 6;
+bool BattleArmy::isFullHouse(void) const
+{
+    return count() >= 6;
 }
 
 Spells BattleArmy::allCastSpells(void) const
@@ -2392,6 +2585,7 @@ bool BattleArmy::join(const Creature & creature, const Land & land)
 	    }
 	}
 
+	unitsValid = false;
 	return party->join(creature);
     }
 
@@ -2401,7 +2595,7 @@ bool BattleArmy::join(const Creature & creature, const Land & land)
 
 bool BattleArmy::isMaximumSummoning(void) const
 {
-    return 4 < toBattleCreatures().size();
+    return 4 < count();
 }
 
 void BattleArmy::remove(const BattleCreature & bcr)
@@ -2417,21 +2611,23 @@ void BattleArmy::applyInvisibility(void)
     {
     	for(auto & land : lands)
     	{
-    	    const LandInfo & borderInfo = GameData::landInfo(land);
-    	    if(borderInfo.clan.isValid() && borderInfo.clan != clan)
+    	    Clan borderClan = GameData::landClan(land);
+    	    if(borderClan.isValid() && borderClan != clan)
     	    {
-            	const BattleParty* party = GameData::getBattleArmy(borderInfo.clan).findPartyConst(land);
-            	if(party && party->toBattleCreatures(Specials() << Speciality::SeeInvisible, true).size())
+            	const BattleParty* party = GameData::getBattleArmy(borderClan).findPartyConst(land);
+            	if(party && party->findSpeciality(Speciality::SeeInvisible))
 		    return land;
     	    }
     	}
 	return Land();
     };
 
-    // remove if Speciality::Invisibility
+    // remove if Speciality::Invisibility: slots checked in place, without creature lists
     for(auto & party : *this)
     {
-	BattleCreatures bcrs = party.toBattleCreatures(Specials() << Speciality::Invisibility, true);
+	if(! party.findSpeciality(Speciality::Invisibility))
+	    continue;
+
         bool remove = true;
 
         // check Speciality::SeeInvisible on borders
@@ -2442,7 +2638,7 @@ void BattleArmy::applyInvisibility(void)
 	    remove = false;
 	else
 	{
-	    auto land = findLandInvisible(positionInfo.borders, positionInfo.clan);
+	    auto land = findLandInvisible(positionInfo.borders, GameData::landClan(positionInfo.id));
 	    if(land.isValid())
 	    {
                 DEBUG("found Speciality::SeeInvisible" << ", " << "land: " << land.toString());
@@ -2451,13 +2647,7 @@ void BattleArmy::applyInvisibility(void)
 	}
 
         if(remove)
-        {
-	    for(auto & bcr : bcrs)
-    	    {
-        	DEBUG("remove Speciality::Invisibility" << ", " << "land: " << party.land().toString() << ", " << "creature: " << bcr->toString());
-        	party.remove(*bcr);
-    	    }
-	}
+	    party.removeSpeciality(Speciality::Invisibility);
     }
 
     shrinkEmpty();
@@ -2466,6 +2656,7 @@ void BattleArmy::applyInvisibility(void)
 void BattleArmy::shrinkEmpty(void)
 {
     remove_if([](const BattleParty & party){ return party.isEmpty(); });
+    unitsValid = false;
 }
 
 std::string BattleArmy::toString(void) const
@@ -2501,9 +2692,7 @@ bool BattleArmy::canMoveCreature(const BattleCreature & bcr, const Land & fromLa
 	    // check owner: skip dest
 	    for(int it = 0; it < path.size() - 1; ++it)
 	    {
-		const LandInfo & land1 = GameData::landInfo(fromLand);
-		const LandInfo & land2 = GameData::landInfo(path[it]);
-		if(land1.clan != land2.clan) return false;
+		if(GameData::landClan(fromLand) != GameData::landClan(path[it])) return false;
 	    }
 	}
     }
@@ -2513,14 +2702,14 @@ bool BattleArmy::canMoveCreature(const BattleCreature & bcr, const Land & fromLa
 
 bool BattleArmy::moveCreature(const BattleCreature & bcr, const Land & toLand)
 {
-    auto it = std::find_if(begin(), end(), [&](BattleParty & party){ return party.findBattleUnit(bcr.battleUnit()); });
-    if(it == end())
+    BattleParty* party = findPartyOfUnit(bcr.battleUnit());
+    if(! party)
     {
 	ERROR("creature not found, unit: " << bcr.battleUnit());
 	return false;
     }
 
-    BattleParty & fromParty = *it;
+    BattleParty & fromParty = *party;
     BattleParty* toParty = findParty(toLand);
     const Land & fromLand = fromParty.land();
 
@@ -2551,6 +2740,7 @@ bool BattleArmy::moveCreature(const BattleCreature & bcr, const Land & toLand)
     {
 	push_back(BattleParty(fromParty.clan(), toLand));
 	toParty = & back();
+	unitsValid = false;
     }
 
     BattleCreature* battle = findBattleUnit(bcr.battleUnit());
@@ -2561,9 +2751,9 @@ bool BattleArmy::moveCreature(const BattleCreature & bcr, const Land & toLand)
 	toParty->join(*battle);
     }
 
-    // remove
+    // remove: the copy joined above keeps the unit id
     fromParty.remove(bcr);
-    remove_if([](const BattleParty & party){ return party.isEmpty(); });
+    shrinkEmpty();
 
     return true;
 }
@@ -2778,34 +2968,20 @@ WinRules WinRules::fromJsonArray(const JsonArray & ja)
 /* CroupierSet */
 CroupierSet::CroupierSet() : last(0)
 {
-    bank.reserve(136); // stones(skull9+sword9+number9+wind4+dragon3) * 4
-    trash.reserve(136);
+    bank.reserve(WallSize); // stones(skull9+sword9+number9+wind4+dragon3) * 4
+    trash.reserve(WallSize);
     reset();
 }
 
 void CroupierSet::reset(void)
 {
-    auto stones = { Stone::Skull1, Stone::Skull2, Stone::Skull3, Stone::Skull4, Stone::Skull5, Stone::Skull6, Stone::Skull7, Stone::Skull8, Stone::Skull9,
-		    Stone::Sword1, Stone::Sword2, Stone::Sword3, Stone::Sword4, Stone::Sword5, Stone::Sword6, Stone::Sword7, Stone::Sword8, Stone::Sword9,
-		    Stone::Number1, Stone::Number2, Stone::Number3, Stone::Number4, Stone::Number5, Stone::Number6, Stone::Number7, Stone::Number8, Stone::Number9,
-		    Stone::Wind1, Stone::Wind2, Stone::Wind3, Stone::Wind4,
-		    Stone::Dragon1, Stone::Dragon2, Stone::Dragon3 };
-
-    std::random_device rd;
-    std::mt19937 mtg(rd());
+    std::mt19937 & mtg = GameData::randomEngine();
 
     bank.clear();
 
-    bank.insert(bank.end(), stones.begin(), stones.end());
-    std::shuffle(bank.begin(), bank.end(), mtg);
-
-    bank.insert(bank.end(), stones.begin(), stones.end());
-    std::shuffle(bank.begin(), bank.end(), mtg);
-
-    bank.insert(bank.end(), stones.begin(), stones.end());
-    std::shuffle(bank.begin(), bank.end(), mtg);
+    for(int it = 0; it < 4; ++it)
+	bank.insert(bank.end(), stones_all.begin(), stones_all.end());
 
-    bank.insert(bank.end(), stones.begin(), stones.end());
     std::shuffle(bank.begin(), bank.end(), mtg);
 
     trash.clear();
@@ -2842,9 +3018,10 @@ Stone CroupierSet::get(RemotePlayer & client)
     {
 	res = *it;
 	bank.erase(it);
-	DEBUG("new bank status:  " << bank.toString());
+	DEBUG("bank size: " << bank.size());
     }
     else
+    if(bank.size())
     {
 	res = bank.back();
 	bank.pop_back();
@@ -2853,6 +3030,17 @@ Stone CroupierSet::get(RemotePlayer & client)
     return res;
 }
 
+Stones CroupierSet::peek(size_t count) const
+{
+    Stones res;
+    auto it = bank.rbegin();
+
+    while(count-- && it != bank.rend())
+	res << *it++;
+
+    return res;
+}
+
 bool CroupierSet::valid(void) const
 {
     return bank.size();
@@ -2867,21 +3055,125 @@ JsonObject CroupierSet::toJsonObject(void) const
 {
     JsonObject jo;
     jo.addInteger("last", last);
-    jo.addArray("bank", bank.toJsonArray());
-    jo.addArray("trash", trash.toJsonArray());
+    jo.addString("wall", packStones(bank));
+    jo.addString("discards", packStones(trash));
     return jo;
 }
 
+/* two digits per stone id: "111253..." */
+std::string CroupierSet::packStones(const VecStones & stones)
+{
+    std::string res;
+    res.reserve(stones.size() * 2);
+
+    for(auto & stone : stones)
+    {
+	res.push_back('0' + stone() / 10);
+	res.push_back('0' + stone() % 10);
+    }
+
+    return res;
+}
+
+VecStones CroupierSet::unpackStones(const std::string & str)
+{
+    VecStones res;
+    res.reserve(str.size() / 2);
+
+    for(size_t pos = 0; pos + 1 < str.size(); pos += 2)
+    {
+	Stone stone(static_cast<Stone::stone_t>((str[pos] - '0') * 10 + (str[pos + 1] - '0')));
+	if(stone.isValid()) res.push_back(stone);
+    }
+
+    return res;
+}
+
+/* TileTracker */
+void TileTracker::reset(void)
+{
+    seen.fill(0);
+    for(auto & counts : discards)
+	counts.fill(0);
+}
+
+void TileTracker::drop(const Wind & wind, const Stone & stone)
+{
+    if(stone.isValid())
+    {
+	seen.add(stone);
+	discards[wind()].add(stone);
+    }
+}
+
+void TileTracker::expose(const WinRule & rule)
+{
+    // concealed kong: the stones stay out of the public table
+    if(rule.isConcealed())
+	return;
+
+    if(rule.isChao())
+    {
+	seen.add(rule.stone());
+	seen.add(rule.stone().next());
+	seen.add(rule.stone().next().next());
+    }
+    else
+	seen[rule.stone()()] += rule.count();
+}
+
+void TileTracker::claim(const WinRule & rule, const Stone & dropStone)
+{
+    // drop stone counted on discard
+    expose(rule);
+    if(seen[dropStone()]) seen[dropStone()]--;
+}
+
+void TileTracker::upgradeKong(const Stone & stone)
+{
+    seen.add(stone);
+}
+
+void TileTracker::rebuild(const VecStones & trash, const LocalPlayers & players, const Stone & dropStone)
+{
+    reset();
+
+    // discards owners are not saved
+    for(auto & stone : trash)
+	seen.add(stone);
+
+    if(dropStone.isValid())
+	seen.add(dropStone);
+
+    for(auto & player : players)
+	for(auto & rule : player.rules)
+	    expose(rule);
+}
+
+int TileTracker::unseen(const Stone & stone, const GameStones & own) const
+{
+    int res = 4 - seen[stone()] - own.countStone(stone);
+    return 0 < res ? res : 0;
+}
+
 CroupierSet CroupierSet::fromJsonObject(const JsonObject & jo)
 {
     CroupierSet res;
-    const JsonArray* ja = nullptr;
 
-    ja = jo.getArray("bank");
-    if(ja) res.bank = VecStones::fromJsonArray(*ja);
+    if(jo.hasKey("wall"))
+    {
+	res.bank = unpackStones(jo.getString("wall"));
+	res.trash = unpackStones(jo.getString("discards"));
+    }
+    else
+    {
+	// old saves: stone names array
+	const JsonArray* ja = jo.getArray("bank");
+	if(ja) res.bank = VecStones::fromJsonArray(*ja);
 
-    ja = jo.getArray("trash");
-    if(ja) res.trash = VecStones::fromJsonArray(*ja);
+	ja = jo.getArray("trash");
+	if(ja) res.trash = VecStones::fromJsonArray(*ja);
+    }
 
     res.last = jo.getInteger("last", 0);
     return res;
@@ -2931,8 +3223,7 @@ Persons::Persons(const Person & person)
     std::vector<Clan::clan_t> clans(clans_all);
     clans.erase(std::find(clans.begin(), clans.end(), person.clan.id()));
 
-    std::random_device rd;
-    std::mt19937 mtg(rd());
+    std::mt19937 & mtg = GameData::randomEngine();
 
     while(! clans.empty())
     {
@@ -3174,27 +3465,143 @@ bool LocalPlayer::allowCastSpell(const Spell & spell) const
 	    return false;
     }
 
-    const SpellInfo & spellInfo = GameData::spellInfo(spell);
-    return stones.allowCast(spellInfo.stones, newStone);
+    return allowCastRunes(spell);
 }
 
-bool LocalPlayer::isMahjongChao(const Wind & currentWind, const Stone & dropStone) const
+bool LocalPlayer::allowCastRunes(const Spell & spell) const
 {
-    if(isAffectedSpell(Spell::Silence))
-        return false;
+    if(! casts.isValid(stones, newStone))
+	casts.rebuild(stones, newStone);
 
-    return dropStone.isValid() && ! dropStone.isSpecial() &&
-        wind == currentWind.next() &&
-        stones.findChaoVariants(dropStone).size();
+    return casts.allowSpell(spell);
 }
 
-bool LocalPlayer::isMahjongPung(const Wind & currentWind, const Stone & dropStone) const
+bool LocalPlayer::allowSummonRunes(const Creature & creature) const
+{
+    if(! casts.isValid(stones, newStone))
+	casts.rebuild(stones, newStone);
+
+    return casts.allowCreature(creature);
+}
+
+/* ClaimTable */
+bool ClaimTable::isValid(const Stones & stones, const WinRules & rules) const
+{
+    if(handCount != stones.size() || rulesCount != rules.size())
+	return false;
+
+    for(size_t it = 0; it < stones.size(); ++it)
+	if(hand[it] != stones[it]()) return false;
+
+    return true;
+}
+
+void ClaimTable::rebuild(const Stones & stones, const WinRules & rules)
+{
+    std::array<uint8_t, Stone::Dragon3 + 3> counts;
+    counts.fill(0);
+
+    for(auto & stone : stones)
+	if(stone.isValid()) counts[stone()]++;
+
+    claims.fill(0);
+
+    for(int id = Stone::Skull1; id <= Stone::Dragon3; ++id)
+    {
+	if(1 < counts[id]) claims[id] |= Pung;
+	if(2 < counts[id]) claims[id] |= Kong;
+
+	// chao: suits only, gaps between suits have zero count
+	if(id < Stone::Wind1 &&
+	    ((counts[id - 2] && counts[id - 1]) || (counts[id - 1] && counts[id + 1]) || (counts[id + 1] && counts[id + 2])))
+	    claims[id] |= Chao;
+    }
+
+    handCount = stones.size() <= hand.size() ? stones.size() : 0xFF;
+    rulesCount = rules.size();
+
+    for(size_t it = 0; it < stones.size() && it < hand.size(); ++it)
+	hand[it] = stones[it]();
+}
+
+/* CastTable */
+bool CastTable::isValid(const GameStones & stones, const GameStone & stone) const
+{
+    if(handCount != stones.size() || newStone != (stone() | (stone.isCasted() ? 0x80 : 0)))
+	return false;
+
+    for(size_t it = 0; it < stones.size(); ++it)
+	if(hand[it] != (stones[it]() | (GameStone::isCasted(stones[it]) ? 0x80 : 0))) return false;
+
+    return true;
+}
+
+void CastTable::rebuild(const GameStones & stones, const GameStone & stone)
+{
+    spellsKnown = 0;
+    spellsAllow = 0;
+    creaturesKnown = 0;
+    creaturesAllow = 0;
+    uncasted = stones.uncastedCounts(stone);
+
+    handCount = stones.size() <= hand.size() ? stones.size() : 0xFF;
+    newStone = stone() | (stone.isCasted() ? 0x80 : 0);
+
+    for(size_t it = 0; it < stones.size() && it < hand.size(); ++it)
+	hand[it] = stones[it]() | (GameStone::isCasted(stones[it]) ? 0x80 : 0);
+}
+
+bool CastTable::allowSpell(const Spell & spell)
+{
+    const uint32_t bit = 1u << spell();
+
+    if(! (spellsKnown & bit))
+    {
+	spellsKnown |= bit;
+	if(uncasted.contains(GameData::spellInfo(spell).runes)) spellsAllow |= bit;
+    }
+
+    return spellsAllow & bit;
+}
+
+bool CastTable::allowCreature(const Creature & creature)
+{
+    const uint32_t bit = 1u << creature();
+
+    if(! (creaturesKnown & bit))
+    {
+	creaturesKnown |= bit;
+	if(uncasted.contains(GameData::creatureInfo(creature).runes)) creaturesAllow |= bit;
+    }
+
+    return creaturesAllow & bit;
+}
+
+const ClaimTable & LocalPlayer::claimTable(void) const
+{
+    if(! claims.isValid(stones.toStones(), rules))
+	claims.rebuild(stones.toStones(), rules);
+
+    return claims;
+}
+
+bool LocalPlayer::isMahjongChao(const Wind & currentWind, const Stone & dropStone) const
+{
+    if(isAffectedSpell(Spell::Silence))
+        return false;
+
+    return dropStone.isValid() && ! dropStone.isSpecial() &&
+        wind == currentWind.next() &&
+        claimTable().isChao(dropStone);
+}
+
+bool LocalPlayer::isMahjongPung(const Wind & currentWind, const Stone & dropStone) const
 {
     if(isAffectedSpell(Spell::Silence))
         return false;
 
     if(dropStone.isValid() && currentWind != wind)
-        return 1 < stones.countStone(dropStone);
+        return claimTable().isPung(dropStone);
 
     return false;
 }
@@ -3205,7 +3612,7 @@ bool LocalPlayer::isMahjongKong1(const Wind & currentWind, const Stone & dropSto
         return false;
 
     if(dropStone.isValid() && currentWind != wind)
-        return 2 < stones.countStone(dropStone);
+        return claimTable().isKong(dropStone);
 
     return false;
 }
@@ -3225,6 +3632,24 @@ bool LocalPlayer::isMahjongKong2(const Wind & currentWind) const
 }
 
 bool LocalPlayer::isWinMahjong(const Wind & currentWind, const Wind & roundWind, const Stone & dropStone, WinResults* winResult) const
+{
+    // discard claim: cached for the hand
+    if(! newStone.isValid() && dropStone.isValid())
+    {
+	const ClaimTable & table = claimTable();
+
+	if(table.isGameKnown(dropStone) && (! table.isGame(dropStone) || ! winResult))
+	    return table.isGame(dropStone);
+
+	bool res = checkWinMahjong(currentWind, roundWind, dropStone, winResult);
+	claims.setGame(dropStone, res);
+	return res;
+    }
+
+    return checkWinMahjong(currentWind, roundWind, dropStone, winResult);
+}
+
+bool LocalPlayer::checkWinMahjong(const Wind & currentWind, const Wind & roundWind, const Stone & dropStone, WinResults* winResult) const
 {
     Stone winStone;
 
@@ -3236,7 +3661,7 @@ bool LocalPlayer::isWinMahjong(const Wind & currentWind, const Wind & roundWind,
     else
         return false;
 
-    Stones stones2 = stones;
+    Stones stones2 = stones.toStones();
     stones2.push_back(winStone);
 
     Stones pairs = stones2.findPairs();
@@ -3286,7 +3711,7 @@ Stone LocalPlayer::setMahjongDrop(int indexDrop)
     if(stones.size() < indexDrop)
     {
 	ERROR("index out of range");
-	indexDrop = Tools::rand(0, stones.size() - 1);
+	indexDrop = GameData::random(0, stones.size() - 1);
     }
 
     Stone dropStone;
@@ -3308,7 +3733,7 @@ Stone LocalPlayer::setMahjongDrop(int indexDrop)
     {
 	affectedSpellActivate(Spell::RandomDiscard);
 	stones.add(dropStone);
-	indexDrop = Tools::rand(0, stones.size() - 1);
+	indexDrop = GameData::random(0, stones.size() - 1);
 	dropStone = stones[indexDrop];
 	stones.del(indexDrop);
 	DEBUG("random discard affected" << ", " << "drop stone: " << dropStone.id());
@@ -3331,7 +3756,7 @@ void LocalPlayer::setMahjongChao(const Stone & dropStone, int index)
     if(variants.size() < index)
     {
         if(1 < variants.size())
-            index = Tools::rand(0, variants.size() - 1);
+            index = GameData::random(0, variants.size() - 1);
         else
         if(variants.size())
             index = 0;
@@ -3486,6 +3911,11 @@ bool LocalPlayers::findKongs(void) const
     return std::any_of(begin(), end(), [](const LocalPlayer & lp){ return lp.haveKong(); });
 }
 
+bool LocalPlayers::isAllAI(void) const
+{
+    return std::all_of(begin(), end(), [](const LocalPlayer & lp){ return lp.isAI(); });
+}
+
 JsonArray LocalPlayers::toJsonArray(void) const
 {
     JsonArray ja;
@@ -3652,78 +4082,6 @@ Stones RuneBonus::stones(void) const
     return res;
 }
 
-RuneBonusList WinResults::bonusRunes(void) const
-{
-    RuneBonusList res;
-
-    for(auto & winRule : rules)
-    {
-	const Stone & stone = winRule.stone();
-	const int & rule = winRule.rule();
-	const bool & concealed = winRule.isConcealed();
-	int type = 0; int value = 0;
-
-        switch(rule)
-        {
-	    case WinRule::Pung:
-		if(stone.isHonor() || stone.isTerminal())
-		{
-		    type |= RuneBonus::RunePung | (stone.isHonor() ? RuneBonus::RuneHonor : RuneBonus::RuneTerminal);
-		    value = concealed ? 8 : 4;
-		}
-		else
-		{
-		    type |= RuneBonus::RunePung | RuneBonus::RuneSimple;
-		    value = concealed ? 4 : 2;
-		}
-		break;
-
-	    case WinRule::Kong:
-		if(stone.isHonor() || stone.isTerminal())
-		{
-		    type |= RuneBonus::RuneKong | (stone.isHonor() ? RuneBonus::RuneHonor : RuneBonus::RuneTerminal);
-		    value = concealed ? 32 : 16;
-		}
-		else
-		{
-		    type |= RuneBonus::RuneKong | RuneBonus::RuneSimple;
-		    value = concealed ? 16 : 8;
-		}
-		break;
-
-	    case WinRule::Chao:
-		    type |= RuneBonus::RuneChao | RuneBonus::RuneSimple;
-		    value = 0;
-		break;
-
-    	    default:
-		break;
-        }
-
-	if(stone.isWind())
-	{
-	    if(stone.isWind(roundWind)) type |= RuneBonus::RuneLucky;
-	    if(stone.isWind(winWind)) type |= RuneBonus::RuneLucky;
-	}
-	else
-	if(stone.isDragon())
-	{
-	    type |= RuneBonus::RuneLucky;
-	}
-
-	if(concealed) type |= RuneBonus::RuneConcealed;
-	res << RuneBonus(stone, type, value);
-    }
-
-    // add pair
-    int type = RuneBonus::RunePair;
-    if(lastStone != pairStone) type |= RuneBonus::RuneConcealed;
-
-    res << RuneBonus(pairStone, type, pairBonus());
-
-    return res;
-}
-
 Wind OpponentFine::wind(void) const
 {
     switch(type())
@@ -3738,266 +4096,199 @@ Wind OpponentFine::wind(void) const
     return Wind::None;
 }
 
-int WinResults::scoreRules(void) const
+bool ScoreBreakdown::isHand(int type) const
 {
-    int res = 0;
-    RuneBonusList list = bonusRunes();
-    for(auto it = list.begin(); it != list.end(); ++it) res += (*it).value();
-    return res;
+    return std::any_of(hands.begin(), hands.begin() + handsCount,
+		[=](const HandBonus & bonus){ return bonus.isType(type); });
 }
 
-bool WinResults::noPoints(void) const
+bool WinResults::makeScoreKey(ScoreKey & key) const
 {
-    return 0 == scoreRules();
-}
+    const size_t fixed = 6;
 
-int WinResults::baseScore(void) const
-{
-    return 20;
-}
+    if(fixed + rules.size() > key.size())
+	return false;
 
-int WinResults::pairBonus(void) const
-{
-    // pair bonus: double wind
-    if(pairStone.isWind(roundWind) && pairStone.isWind(winWind))
-        return 4;
-    else
-    // pair bonus: lucky runes
-    if(pairStone.isDragon() || pairStone.isWind(roundWind) || pairStone.isWind(winWind))
-        return 2;
+    key.fill(0);
+    key[0] = dealWind();
+    key[1] = winWind();
+    key[2] = roundWind();
+    key[3] = pairStone();
+    key[4] = lastStone();
+    key[5] = flags();
 
-    return 0;
+    for(size_t it = 0; it < rules.size(); ++it)
+	key[fixed + it] = rules[it].rule() | (rules[it].stone()() << 8) | rules[it].flags();
+
+    return true;
 }
 
-HandBonusList WinResults::bonusHands(void) const
+const ScoreBreakdown & WinResults::breakdown(void) const
 {
-    HandBonusList res;
+    ScoreKey key;
 
-    // 2 points for "One Chance" and "Self Drawn" are not counted if the hand would otherwise be "No Points".
-    if(! noPoints())
+    // public fields: check the key, not only the valid flag
+    if(! makeScoreKey(key))
+	calcBreakdown(score);
+    else
+    if(! score.valid || key != scoreKey)
     {
-	// other bonus: one chance hand
-	if(pairStone == lastStone || pairStone.isLucky())
-	    res << HandBonus(HandBonus::OneChance, 2);
-	else
-	{
-	    if(std::any_of(rules.begin(), rules.end(),
-		[&](const WinRule & rule){ return rule.isOneChance(pairStone); }))
-		res << HandBonus(HandBonus::OneChance, 2);
-	}
-
-	// other bonus: self-drawn hand
-	if(isSelfDrawn())
-	    res << HandBonus(HandBonus::SelfDrawn, 2);
+	calcBreakdown(score);
+	score.valid = true;
+	scoreKey = key;
     }
 
-    // other bonus: Concealed hand with	discarded tile
-    if(flags.check(AllConcealedWithDiscard))
-	res << HandBonus(HandBonus::AllConcealedWithDiscard, 10);
-
-    return res;
+    return score;
 }
 
-int WinResults::totalPoints(void) const
+void WinResults::calcBreakdown(ScoreBreakdown & res) const
 {
-    int res = baseScore();
+    const ScoreTable & table = GameData::scoreTable();
 
-    res += scoreRules();
-    res += pairBonus();
+    ScoreFeatures features;
+    features.fill(0);
 
-    for(auto & bonus : bonusHands())
-	res += bonus.value();
+    res = ScoreBreakdown();
 
-    return res;
-}
+    int orderedSkull = 0;
+    int orderedNumber = 0;
+    int orderedSword = 0;
+    bool oneSuit = true;
+    bool oneSuitHonors = true;
+    int suitType = pairStone.isHonor() ? 0 : pairStone.stoneType();
 
-DoubleBonusList WinResults::bonusDoubles(void) const
-{
-    DoubleBonusList res;
+    // single pass over sets: rune values and hand features
+    for(auto & winRule : rules)
+    {
+	const Stone & stone = winRule.stone();
+	const bool & concealed = winRule.isConcealed();
+	const bool outer = stone.isHonor() || stone.isTerminal();
+	int type = 0;
 
-    // No Points: 1
-    if(noPoints())
-	res << DoubleBonus(DoubleBonus::NoPoints, 1);
+        switch(winRule.rule())
+        {
+	    case WinRule::Pung:
+		type |= RuneBonus::RunePung | (outer ? (stone.isHonor() ? RuneBonus::RuneHonor : RuneBonus::RuneTerminal) : RuneBonus::RuneSimple);
+		break;
 
-    // Little three dragons: 1
-    // (3 dragon sets, one being a pair)
-    if(pairStone.isDragon())
-    {
-	if(2 == rules.countStoneType(StoneType::IsDragon))
-	    res << DoubleBonus(DoubleBonus::ThreeLittleDragons, 1);
-    }
-    else
-    // little four winds: 1
-    if(pairStone.isWind())
-    {
-	if(3 == rules.countStoneType(StoneType::IsWind))
-	    res << DoubleBonus(DoubleBonus::LittleFourWinds, 1);
-    }
+	    case WinRule::Kong:
+		type |= RuneBonus::RuneKong | (outer ? (stone.isHonor() ? RuneBonus::RuneHonor : RuneBonus::RuneTerminal) : RuneBonus::RuneSimple);
+		break;
 
-    // three big dragons
-    if(3 == rules.countStoneType(StoneType::IsDragon))
-    {
-	res << DoubleBonus(DoubleBonus::ThreeBigDragons, 5);
-    }
-    // big four winds
-    else
-    if(4 == rules.countStoneType(StoneType::IsWind))
-    {
-	res << DoubleBonus(DoubleBonus::BigFourWinds, 5);
-    }
+	    case WinRule::Chao:
+		type |= RuneBonus::RuneChao | RuneBonus::RuneSimple;
+		break;
 
-    // Lucky Sets:
-    {
-	int value = 0;
+    	    default:
+		break;
+        }
 
-	for(auto & rule : rules)
+	if(stone.isWind())
 	{
-	    // pung, kong only
-	    if(! rule.isChao())
-	    {
-		// Double Wind triplet or foursome: 2
-		if(rule.stone().isWind(roundWind) && rule.stone().isWind(winWind))
-		    value += 2;
-		else
-		// Lucky triplet or foursome: 1
-		if((rule.stone().isDragon() || rule.stone().isWind(roundWind) || rule.stone().isWind(winWind)))
-		    value += 1;
-	    }
+	    if(stone.isWind(roundWind)) type |= RuneBonus::RuneLucky;
+	    if(stone.isWind(winWind)) type |= RuneBonus::RuneLucky;
 	}
-
-	if(value) res << DoubleBonus(DoubleBonus::LuckySets, value);
-    }
-
-    // Four triplets or foursomes:
-    // 0, 1, or 2 concealed: 1
-    // 3 concealed: 2
-    // 4 concealed: Limit (5 - 500pt)
-    int chaoCount = std::count_if(rules.begin(), rules.end(), [](const WinRule & rule){ return rule.isChao(); });
-
-    if(0 == chaoCount)
-    {
-	int concealed = std::count_if(rules.begin(), rules.end(),
-			[](const WinRule & rule){ return rule.isConcealed(); });
-
-	if(3 < concealed)
-	    res << DoubleBonus(DoubleBonus::FourConcealedTriplets, 5);
 	else
-	    res << DoubleBonus(DoubleBonus::FourTriplets, 2 < concealed ? 2 : 1);
-    }
-
-    // Three concealed triplets, one sequence: 1
-    if(1 == chaoCount)
-    {
-	int concealed = std::count_if(rules.begin(), rules.end(),
-			[](const WinRule & rule){ return ! rule.isChao() && rule.isConcealed(); });
-
-	if(3 == concealed)
-	    res << DoubleBonus(DoubleBonus::ThreeConcealedTriplets, 1);
-    }
+	if(stone.isDragon())
+	{
+	    type |= RuneBonus::RuneLucky;
+	}
 
-    // Three consecutive sequences: 1
-    // (1,2,3 4,5,6 7,8,9 of same suit)
-    {
-	WinRules tmp = rules;
-	auto itend = std::remove_if(tmp.begin(), tmp.end(),
-		    [](const WinRule & rule){ return rule.stoneOrder(1) || rule.stoneOrder(4) || rule.stoneOrder(7); });
+	if(concealed) type |= RuneBonus::RuneConcealed;
 
-	if(3 <= std::distance(itend, tmp.end()))
+	features[Score::SetPung] = winRule.isPung();
+	features[Score::SetKong] = winRule.isKong();
+	features[Score::SetChao] = winRule.isChao();
+	features[Score::SetOuter] = outer;
+	features[Score::SetConcealed] = concealed;
+
+	int value = table.value(Score::Runes, features);
+	res.addRune(RuneBonus(stone, type, value));
+	res.scoreRules += value;
+
+	features[Score::SetsDragon] += winRule.stoneType(StoneType::IsDragon);
+	features[Score::SetsWind] += winRule.stoneType(StoneType::IsWind);
+	features[Score::SetsConcealed] += concealed;
+	features[Score::SetsTerminal] += winRule.stoneTerminal();
+	features[Score::SetsHonor] += winRule.stoneHonor();
+	features[Score::SetsOneChance] += winRule.isOneChance(pairStone);
+
+	if(winRule.isChao())
+	    features[Score::SetsChao]++;
+	else
 	{
-	    int type = 0;
-
-	    if(3 == std::count_if(itend, tmp.end(), [](const WinRule & rule) { return rule.stoneType(StoneType::IsSkull); }))
-		type = StoneType::IsSkull;
-	    else
-	    if(3 == std::count_if(itend, tmp.end(), [](const WinRule & rule) { return rule.stoneType(StoneType::IsNumber); }))
-		type = StoneType::IsNumber;
+	    // double wind set: 2, lucky set: 1
+	    if(stone.isWind(roundWind) && stone.isWind(winWind))
+		features[Score::SetsLucky] += 2;
 	    else
-	    if(3 == std::count_if(itend, tmp.end(), [](const WinRule & rule) { return rule.stoneType(StoneType::IsSword); }))
-		type = StoneType::IsSword;
+	    if(stone.isDragon() || stone.isWind(roundWind) || stone.isWind(winWind))
+		features[Score::SetsLucky] += 1;
 
-	    if(type)
-		res << DoubleBonus(DoubleBonus::ThreeConsecutiveSequences, 1);
+	    features[Score::SetsConcealedTriplets] += concealed;
 	}
-    }
-
-    // All Terminals and Honors: 1
-    if(pairStone.isTerminal() || pairStone.isHonor())
-    {
-	int terminals = std::count_if(rules.begin(), rules.end(), [](const WinRule & rule) { return rule.stoneTerminal(); });
-	int honors = std::count_if(rules.begin(), rules.end(), [](const WinRule & rule) { return rule.stoneHonor(); });
 
-	if(4 == terminals && pairStone.isTerminal())
-	    res << DoubleBonus(DoubleBonus::AllTerminals, 5);
-	else
-	if(4 == honors && pairStone.isHonor())
-	    res << DoubleBonus(DoubleBonus::AllHonors, 5);
-	else
-	if(4 == terminals + honors)
-	    res << DoubleBonus(DoubleBonus::TerminalsHonors, 1);
-    }
-    else
-    // All Simples: 1
-    {
-	int terminals = std::count_if(rules.begin(), rules.end(), [](const WinRule & rule) { return rule.stoneTerminal(); });
-	int honors = std::count_if(rules.begin(), rules.end(), [](const WinRule & rule) { return rule.stoneHonor(); });
+	// 1,2,3 4,5,6 7,8,9
+	if(winRule.stoneOrder(1) || winRule.stoneOrder(4) || winRule.stoneOrder(7))
+	{
+	    orderedSkull += winRule.stoneType(StoneType::IsSkull);
+	    orderedNumber += winRule.stoneType(StoneType::IsNumber);
+	    orderedSword += winRule.stoneType(StoneType::IsSword);
+	}
 
-	if(0 == terminals + honors)
-	    res << DoubleBonus(DoubleBonus::AllSimples, 1);
+	if(! winRule.stoneType(pairStone.stoneType())) oneSuit = false;
 
+	if(! winRule.stoneHonor())
+	{
+	    if(! suitType) suitType = stone.stoneType();
+	    if(! winRule.stoneType(suitType)) oneSuitHonors = false;
+	}
     }
 
-    // One suit only: 4
-    if(std::all_of(rules.begin(), rules.end(), [&](const WinRule & rule) { return rule.stoneType(pairStone.stoneType()); }))
-	res << DoubleBonus(DoubleBonus::OneSuitOnly, 4);
+    features[Score::SetsTerminalHonor] = features[Score::SetsTerminal] + features[Score::SetsHonor];
+    features[Score::SetsOrderedSuit] = std::max(orderedSkull, std::max(orderedNumber, orderedSword));
 
-    // One suit with honors: 1
-    {
-	WinRules tmp = rules;
-	auto itend = std::remove_if(tmp.begin(), tmp.end(), [](const WinRule & rule){ return rule.stoneHonor(); });
-	int type = 0;
+    features[Score::PairDragon] = pairStone.isDragon();
+    features[Score::PairWind] = pairStone.isWind();
+    features[Score::PairTerminal] = pairStone.isTerminal();
+    features[Score::PairHonor] = pairStone.isHonor();
+    features[Score::PairLucky] = pairStone.isLucky();
+    features[Score::PairLast] = pairStone == lastStone;
+    features[Score::PairRoundWind] = pairStone.isWind(roundWind);
+    features[Score::PairWinWind] = pairStone.isWind(winWind);
 
-	if(! pairStone.isHonor())
-	    type = pairStone.stoneType();
-	else
-	if(tmp.begin() != itend)
-	    type = tmp.front().stone().stoneType();
+    // add pair
+    int pairType = RuneBonus::RunePair;
+    if(lastStone != pairStone) pairType |= RuneBonus::RuneConcealed;
 
-	if(type && std::all_of(tmp.begin(), itend, [=](const WinRule & rule){ return rule.stoneType(type); }))
-	    res << DoubleBonus(DoubleBonus::OneSuitHonors, 1);
-    }
+    res.pairBonus = table.value(Score::Pair, features);
+    res.addRune(RuneBonus(pairStone, pairType, res.pairBonus));
+    res.scoreRules += res.pairBonus;
 
-//    last:
-//    TerminalHonorEachSet,
-//    SupplementalTile, LastTileWall,
+    features[Score::HandNoPoints] = res.noPoints();
+    features[Score::HandSelfDrawn] = isSelfDrawn();
+    features[Score::HandConcealedDiscard] = flags.check(AllConcealedWithDiscard);
+    features[Score::HandOneSuit] = oneSuit;
+    features[Score::HandOneSuitHonors] = suitType && oneSuitHonors;
 
-//    AllConcealedSelfDrawn, RobbedKong, HeavenlyHand, EarthlyHand
+    // hands
+    table.apply(Score::Hands, features, [&](int bonus, int value){ res.addHand(HandBonus(bonus, value)); });
 
-//Terminal or honor in each set           1 (only applies if the hand contains at least one sequence)
-//
-//Ways of Going Out
-//     Supplemental Tile                  1
-//     Last Tile of Wall                  1
+    res.baseScore = table.base();
+    res.totalPoints = res.baseScore + res.scoreRules + res.pairBonus;
 
-    return res;
-}
+    for(int it = 0; it < res.handsCount; ++it)
+	res.totalPoints += res.hands[it].value();
 
-int WinResults::totalScore(void) const
-{
-    int doubles = 0;
+    // doubles
+    table.apply(Score::Doubles, features, [&](int bonus, int value){ res.addDouble(DoubleBonus(bonus, value)); });
 
-    DoubleBonusList list = bonusDoubles();
-    for(auto it = list.begin(); it != list.end(); ++it) doubles += (*it).value();
+    for(int it = 0; it < res.doublesCount; ++it)
+	res.totalDoubles += res.doubles[it].value();
 
-    int res = baseScore() * (doubles ? (2 << (doubles - 1)) : 1);
-    if(res > 500) res = 500;
-
-    return res;
-}
-
-OpponentFinesList WinResults::opponentFines(void) const
-{
-    OpponentFinesList res;
+    res.totalScore = res.baseScore * (res.totalDoubles ? (2 << (res.totalDoubles - 1)) : 1);
+    if(res.totalScore > table.limit()) res.totalScore = table.limit();
 
+    // fines
     // If dealer wins self-drawn:            Receives x2 from each player.
     // If dealer wins from discard:          Receives x6 from discarder.
     // If non-dealer wins self drawn:        Receives x2 from dealer, Receives x1 from other players.
@@ -4014,12 +4305,12 @@ OpponentFinesList WinResults::opponentFines(void) const
 	    for(auto & id : winds_all)
 	    {
                 if(windWin.id() != id)
-                    res << OpponentFine(id, 2);
+                    res.addFine(OpponentFine(id, 2));
 	    }
         }
         else
         {
-            res << OpponentFine(windCurrent, 6);
+            res.addFine(OpponentFine(windCurrent, 6));
         }
     }
     else
@@ -4029,14 +4320,74 @@ OpponentFinesList WinResults::opponentFines(void) const
 	    for(auto & id : winds_all)
 	    {
                 if(windWin.id() != id)
-                    res << OpponentFine(id, (windCurrent.id() == id ? 2 : 1));
+                    res.addFine(OpponentFine(id, (windCurrent.id() == id ? 2 : 1)));
 	    }
         }
         else
         {
-            res << OpponentFine(windCurrent, 4);
+            res.addFine(OpponentFine(windCurrent, 4));
         }
     }
+}
+
+RuneBonusList WinResults::bonusRunes(void) const
+{
+    const ScoreBreakdown & bd = breakdown();
+    RuneBonusList res;
+    for(int it = 0; it < bd.runesCount; ++it) res << bd.runes[it];
+    return res;
+}
+
+int WinResults::scoreRules(void) const
+{
+    return breakdown().scoreRules;
+}
 
+bool WinResults::noPoints(void) const
+{
+    return breakdown().noPoints();
+}
+
+int WinResults::baseScore(void) const
+{
+    return breakdown().baseScore;
+}
+
+int WinResults::pairBonus(void) const
+{
+    return breakdown().pairBonus;
+}
+
+HandBonusList WinResults::bonusHands(void) const
+{
+    const ScoreBreakdown & bd = breakdown();
+    HandBonusList res;
+    for(int it = 0; it < bd.handsCount; ++it) res << bd.hands[it];
+    return res;
+}
+
+int WinResults::totalPoints(void) const
+{
+    return breakdown().totalPoints;
+}
+
+DoubleBonusList WinResults::bonusDoubles(void) const
+{
+    const ScoreBreakdown & bd = breakdown();
+    DoubleBonusList res;
+    for(int it = 0; it < bd.doublesCount; ++it) res << bd.doubles[it];
+    return res;
+}
+
+int WinResults::totalScore(void) const
+{
+    return breakdown().totalScore;
+}
+
+OpponentFinesList WinResults::opponentFines(void) const
+{
+    const ScoreBreakdown & bd = breakdown();
+    OpponentFinesList res;
+    for(int it = 0; it < bd.finesCount; ++it) res << bd.fines[it];
     return res;
 }
@@ -24,6 +24,8 @@
 #define _RWNA_GAMEOBJECTS_
 
 #include <set>
+#include <array>
+#include <cstdint>
 
 #include "libswe.h"
 using namespace SWE;
@@ -349,20 +351,53 @@ struct GameStone : Stone
     static GameStone		fromJsonObject(const JsonObject &);
 };
 
-struct GameStones : Stones
+/* stones count, index: Stone::id */
+struct RuneCounts : std::array<uint8_t, 64>
 {
-    void			push_back(const GameStone & stone) { Stones::push_back(stone); }
+    RuneCounts() { fill(0); }
+    RuneCounts(const Stones &);
+
+    void			add(const Stone & st) { (*this)[st()]++; }
+    bool			contains(const RuneCounts &) const;
+};
+
+/* sorted by id and casted first, stones count in sync: read only as vector */
+struct GameStones : protected Stones
+{
+protected:
+    RuneCounts			counts;
 
 public:
-    GameStones() { reserve(68); }
+    typedef Stones::const_iterator const_iterator;
+
+    GameStones() { reserve(18); }
+
+    const_iterator		begin(void) const { return Stones::begin(); }
+    const_iterator		end(void) const { return Stones::end(); }
+    const Stone &		operator[] (size_t pos) const { return Stones::operator[](pos); }
+    const Stone &		back(void) const { return Stones::back(); }
+    const Stones &		toStones(void) const { return *this; }
+
+    using Stones::size;
+    using Stones::empty;
+    using Stones::findChaoVariants;
+    using Stones::haveKong;
 
-    void			add(const GameStone &); // sorted push_back
+    void			add(const GameStone &); // sorted insert
     Stone			del(int);
+    void			clear(void);
     bool			find(const WinRule &) const;
     void			remove(const WinRule &);
 
+    int				countStone(const Stone & st) const { return counts[st()]; }
+    bool			findStone(const Stone & st) const { return counts[st()]; }
+    Stones			findPairs(void) const;
+    const RuneCounts &		stonesCount(void) const { return counts; }
+
     bool			allowCast(const Stones &, const GameStone &) const;
     bool			allowCast(const Stones &) const;
+    bool			allowCast(const RuneCounts &, const GameStone &) const;
+    RuneCounts			uncastedCounts(const GameStone &) const;
     void			setCasted(const Stones &, GameStone &);
 
     std::string			toString(void) const;
@@ -403,6 +438,38 @@ struct Lands : std::vector<Land>
     std::string			toString(void) const;
 };
 
+/* land owners: one byte per land, index: Land::id */
+struct LandOwners : std::array<uint8_t, Land::SiphonsChute + 1>
+{
+    LandOwners() { fill(Clan::None); }
+
+    Clan			clan(const Land & land) const { return Clan(static_cast<Clan::clan_t>((*this)[land()])); }
+    void			setClan(const Land & land, const Clan & clan) { (*this)[land()] = clan(); }
+
+    Lands			thisClan(const Clan &) const;
+
+    JsonArray			toJsonArray(void) const;
+    static LandOwners		fromJsonArray(const JsonArray &);
+};
+
+/* owned lands of one clan: changed with the land owner, read without scan */
+struct ClanLands
+{
+    uint64_t			mask; // bit: land id
+    int				count;
+    int				points;
+    int				powers;
+
+    ClanLands() : mask(0), count(0), points(0), powers(0) {}
+
+    bool			isOwned(const Land & land) const { return mask & (1ULL << land()); }
+    void			add(const Land &);
+    void			remove(const Land &);
+    Lands			toLands(void) const;
+};
+
+static_assert(Land::SiphonsChute < 64, "ClanLands: land mask");
+
 struct BaseStat
 {
     int				attack;
@@ -526,7 +593,7 @@ struct AffectedSpell : Spell
 
 struct AffectedSpells : std::vector<AffectedSpell>
 {
-    AffectedSpells() { reserve(10); }
+    AffectedSpells() {}
 
     bool			isAffected(const Spell &) const;
 
@@ -596,7 +663,7 @@ public:
     //bool			applySpell(const Spell &) override;
 
     const Land &		land(void) const { return territory; }
-    const Clan &		currentClan(void) const;
+    Clan			currentClan(void) const;
     const Clan &		previousClan(void) const;
 
     std::string			toString(void) const;
@@ -679,14 +746,15 @@ struct BattleTargets : std::vector<BattleUnit*>
 
 class BattleArmy;
 
-class BattleParty : protected std::vector<BattleCreature>
+/* three fixed slots stored inline: an empty slot is an invalid creature */
+class BattleParty : protected std::array<BattleCreature, 3>
 {
     Land			position;
     Land			target;
     Clan			owner;
 
 public:
-    BattleParty() { resize(3); }
+    BattleParty() {}
     BattleParty(const Clan &, const Land &);
 
     BattleCreatures		toBattleCreatures(const Specials &, bool filter) const;
@@ -697,8 +765,11 @@ public:
     bool			isPosition(const Land & land) const { return land == position; }
     bool			canJoin(void) const;
     bool			join(const Creature &);
+    bool			join(const BattleCreature &);
     bool			remove(const BattleCreature &);
     void			removeUnloyalty(void);
+    void			removeSpeciality(const Speciality &);
+    bool			findSpeciality(const Speciality &) const;
     int				count(void) const;
     int				movePoint(void) const;
     bool			isEmpty(void) const;
@@ -721,13 +792,36 @@ public:
 
 struct Person;
 
+/* parties change only through BattleArmy: unit and land index kept valid,
+   list nodes keep party and creature pointers stable for ui and ai */
 class BattleArmy : public std::list<BattleParty>
 {
+    /* slot map by battle unit id: ids are never reused, a stale slot can not alias a new unit */
+    struct UnitSlot
+    {
+	BattleParty*		party;
+	int			slot;
+
+	UnitSlot() : party(nullptr), slot(-1) {}
+	UnitSlot(BattleParty* bp, int pos) : party(bp), slot(pos) {}
+    };
+
+    mutable std::vector<UnitSlot> units;
+    mutable std::array<BattleParty*, Land::SiphonsChute + 1> lands;
+    mutable bool		unitsValid;
+
+    void			rebuildUnits(void) const;
+    const UnitSlot*		findUnitSlot(int uid) const;
+
 public:
-    BattleArmy() {}
+    BattleArmy() : unitsValid(false) {}
+    BattleArmy(const BattleArmy & army) : std::list<BattleParty>(army), unitsValid(false) {}
+
+    BattleArmy &		operator= (const BattleArmy &);
 
     BattleParty*		findParty(const Land &);
     const BattleParty*		findPartyConst(const Land &) const;
+    BattleParty*		findPartyOfUnit(int);
 
     bool			findCreature(const Creature &) const;
     BattleCreature*		findBattleUnit(int);
@@ -751,6 +845,7 @@ public:
     void			applyInvisibility(void);
     void			shrinkEmpty(void);
     bool			isFullHouse(void) const;
+    int				count(void) const;
     std::string			toString(void) const;
 
     Spells			allCastSpells(void) const;
@@ -881,8 +976,11 @@ struct WindCompass
 
 struct RemotePlayer;
 
+/* wall: draws from back, suit index lists give O(1) spell draws */
 struct CroupierSet
 {
+    enum { WallSize = 136 };
+
     VecStones                   bank;
     VecStones                   trash;
     int                         last;
@@ -890,12 +988,34 @@ struct CroupierSet
     CroupierSet();
 
     Stone                       get(RemotePlayer &);
+    Stones			peek(size_t count) const;
     void                        reset(void);
     bool                        valid(void) const;
     void                        put(const Stone &);
 
     JsonObject			toJsonObject(void) const;
     static CroupierSet		fromJsonObject(const JsonObject &);
+    static std::string		packStones(const VecStones &);
+    static VecStones		unpackStones(const std::string &);
+};
+
+struct LocalPlayers;
+
+/* public table: discarded and exposed stones, updated by mahjong events */
+struct TileTracker
+{
+    RuneCounts			seen;
+    std::array<RuneCounts, Wind::North + 1> discards; // by wind
+
+    void			reset(void);
+    void			drop(const Wind &, const Stone &);
+    void			expose(const WinRule &);
+    void			claim(const WinRule &, const Stone & dropStone);
+    void			upgradeKong(const Stone &);
+    void			rebuild(const VecStones & trash, const LocalPlayers &, const Stone & dropStone);
+
+    // copies not seen on table and not in own hand
+    int				unseen(const Stone &, const GameStones & own) const;
 };
 
 struct TypeValue : std::pair<int, int>
@@ -987,6 +1107,41 @@ struct OpponentFinesList : std::list<OpponentFine>
     OpponentFinesList &         operator<< (const OpponentFine & st) { push_back(st); return *this; }
 };
 
+/* all win bonuses, computed once per WinResults */
+struct ScoreBreakdown
+{
+    enum { RunesMax = 5, HandsMax = 3, DoublesMax = 12, FinesMax = 3 };
+
+    std::array<RuneBonus, RunesMax>	runes;
+    std::array<HandBonus, HandsMax>	hands;
+    std::array<DoubleBonus, DoublesMax>	doubles;
+    std::array<OpponentFine, FinesMax>	fines;
+
+    int				runesCount;
+    int				handsCount;
+    int				doublesCount;
+    int				finesCount;
+
+    int				baseScore;
+    int				pairBonus;
+    int				scoreRules; // runes with pair
+    int				totalPoints;
+    int				totalDoubles;
+    int				totalScore;
+    bool			valid;
+
+    ScoreBreakdown() : runesCount(0), handsCount(0), doublesCount(0), finesCount(0),
+	baseScore(0), pairBonus(0), scoreRules(0), totalPoints(0), totalDoubles(0), totalScore(0), valid(false) {}
+
+    void			addRune(const RuneBonus & v) { if(runesCount < RunesMax) runes[runesCount++] = v; }
+    void			addHand(const HandBonus & v) { if(handsCount < HandsMax) hands[handsCount++] = v; }
+    void			addDouble(const DoubleBonus & v) { if(doublesCount < DoublesMax) doubles[doublesCount++] = v; }
+    void			addFine(const OpponentFine & v) { if(finesCount < FinesMax) fines[finesCount++] = v; }
+
+    bool			noPoints(void) const { return 0 == scoreRules; }
+    bool			isHand(int type) const;
+};
+
 struct WinResults
 {
     Wind			dealWind;
@@ -997,7 +1152,17 @@ struct WinResults
     BitFlags			flags;
     WinRules			rules;
 
-    WinResults() {}
+protected:
+    typedef std::array<int, 16>	ScoreKey;
+
+    /* breakdown cache: fields above as key, recalculated if changed */
+    mutable ScoreBreakdown	score;
+    mutable ScoreKey		scoreKey;
+
+    bool			makeScoreKey(ScoreKey &) const;
+
+public:
+    WinResults() { scoreKey.fill(0); }
     WinResults(const Wind &, const Wind &, const Wind &, const WinRules &, const WinRules &, const Stone &, const Stone &);
 
     bool			isValid(void) const { return dealWind.isValid(); }
@@ -1006,6 +1171,8 @@ struct WinResults
     bool                        noPoints(void) const;
 
     WinRules			winRulesConcealed(void) const;
+    const ScoreBreakdown &	breakdown(void) const;
+    void			calcBreakdown(ScoreBreakdown &) const; // without cache
 
     RuneBonusList		bonusRunes(void) const;
     HandBonusList		bonusHands(void) const;
@@ -1087,10 +1254,58 @@ struct RemotePlayer : public Person
     static RemotePlayer		fromJsonObject(const JsonObject &);
 };
 
+/* discard claims of the hand, index: Stone::id; rebuilt when stones or rules changed */
+class ClaimTable
+{
+    enum { Pung = 0x01, Kong = 0x02, Chao = 0x04, GameKnown = 0x40, Game = 0x80 };
+
+    std::array<uint8_t, Stone::Dragon3 + 1> claims;
+    std::array<uint8_t, 16>	hand; // signature: stone ids
+    uint8_t			handCount;
+    uint8_t			rulesCount;
+
+public:
+    ClaimTable() : handCount(0xFF), rulesCount(0) { claims.fill(0); hand.fill(0); }
+
+    bool			isValid(const Stones &, const WinRules &) const;
+    void			rebuild(const Stones &, const WinRules &);
+
+    bool			isPung(const Stone & st) const { return claims[st()] & Pung; }
+    bool			isKong(const Stone & st) const { return claims[st()] & Kong; }
+    bool			isChao(const Stone & st) const { return claims[st()] & Chao; }
+    bool			isGameKnown(const Stone & st) const { return claims[st()] & GameKnown; }
+    bool			isGame(const Stone & st) const { return claims[st()] & Game; }
+    void			setGame(const Stone & st, bool f) { claims[st()] |= GameKnown | (f ? Game : 0); }
+};
+
+/* rune check of spells and creatures, index: id; rebuilt when stones changed */
+class CastTable
+{
+    uint32_t			spellsKnown;
+    uint32_t			spellsAllow;
+    uint32_t			creaturesKnown;
+    uint32_t			creaturesAllow;
+    RuneCounts			uncasted;
+    std::array<uint8_t, 16>	hand; // signature: stone ids and casted flags
+    uint8_t			handCount;
+    uint8_t			newStone;
+
+public:
+    CastTable() : spellsKnown(0), spellsAllow(0), creaturesKnown(0), creaturesAllow(0), handCount(0xFF), newStone(0) { hand.fill(0); }
+
+    bool			isValid(const GameStones &, const GameStone &) const;
+    void			rebuild(const GameStones &, const GameStone &);
+
+    bool			allowSpell(const Spell &);
+    bool			allowCreature(const Creature &);
+};
+
 struct LocalPlayer : public RemotePlayer
 {
     GameStones			stones;
     GameStone                   newStone;
+    mutable ClaimTable		claims;
+    mutable CastTable		casts;
 
     LocalPlayer(const RemotePlayer & rp) : RemotePlayer(rp) {}
     LocalPlayer() {}
@@ -1104,6 +1319,8 @@ struct LocalPlayer : public RemotePlayer
 
     bool			haveKong(void) const;
     bool			allowCastSpell(const Spell &) const;
+    bool			allowCastRunes(const Spell &) const;
+    bool			allowSummonRunes(const Creature &) const;
 
     void			initMahjongPart(void);
     void			newTurnEvent(CroupierSet &, bool skipnewStone);
@@ -1114,8 +1331,13 @@ struct LocalPlayer : public RemotePlayer
     bool			isMahjongKong2(const Wind &) const;
     bool			isWinMahjong(const Wind &, const Wind &, const Stone &, WinResults* = nullptr) const;
 
+    const ClaimTable &		claimTable(void) const;
+
     JsonObject			toJsonObject(void) const;
     static LocalPlayer		fromJsonObject(const JsonObject &);
+
+protected:
+    bool			checkWinMahjong(const Wind &, const Wind &, const Stone &, WinResults*) const;
 };
 
 struct LocalPlayers : public std::vector<LocalPlayer>
@@ -1125,6 +1347,7 @@ struct LocalPlayers : public std::vector<LocalPlayer>
     void			shiftWinds(void);
 
     bool			findKongs(void) const;
+    bool			isAllAI(void) const;
 
     LocalPlayer*		playerOfAvatar(const Avatar &);
     LocalPlayer*		playerOfClan(const Clan &);
@@ -1137,6 +1360,7 @@ struct LocalPlayers : public std::vector<LocalPlayer>
 
 extern std::initializer_list<Clan::clan_t> clans_all;
 extern std::initializer_list<Wind::wind_t> winds_all;
+extern std::initializer_list<Stone::stone_t> stones_all;
 extern std::initializer_list<Land::land_t> lands_all;
 extern std::initializer_list<Avatar::avatar_t> avatars_all;
 
@@ -0,0 +1,427 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include <algorithm>
+
+#include "gamestate.h"
+
+namespace GameData
+{
+    extern int bonusChao;
+    extern int bonusPung;
+    extern int bonusKong;
+}
+
+namespace
+{
+    // sort order as GameStone: by id, casted first
+    int stoneOrder(int stone)
+    {
+	return ((stone & State::StoneMask) << 1) | (stone & State::StoneCasted ? 0 : 1);
+    }
+
+    uint8_t stoneValue(const Stone & stone)
+    {
+	return stone() | (GameStone::isCasted(stone) ? State::StoneCasted : 0);
+    }
+
+    int countStone(const StateHand & hand, int stone)
+    {
+	return std::count_if(hand.stones, hand.stones + hand.count,
+				[=](uint8_t st){ return (st & State::StoneMask) == stone; });
+    }
+
+    StateSpells toStateSpells(const AffectedSpells & spells)
+    {
+	StateSpells res = StateSpells();
+
+	for(auto & as : spells)
+	    if(0 <= as() && as() < State::SpellsMax) res.set(as(), as.duration);
+
+	return res;
+    }
+}
+
+/* StateHand */
+int StateHand::find(int stone) const
+{
+    for(int it = 0; it < count; ++it)
+	if((stones[it] & State::StoneMask) == stone) return it;
+
+    return -1;
+}
+
+void StateHand::add(int stone)
+{
+    if(count >= State::HandMax)
+    {
+	ERROR("hand is full");
+	return;
+    }
+
+    int pos = count;
+    while(0 < pos && stoneOrder(stone) < stoneOrder(stones[pos - 1]))
+    {
+	stones[pos] = stones[pos - 1];
+	pos--;
+    }
+
+    stones[pos] = stone;
+    count++;
+}
+
+int StateHand::del(int index)
+{
+    if(index < 0 || index >= count)
+	return Stone::None;
+
+    int res = stones[index];
+    std::copy(stones + index + 1, stones + count, stones + index);
+    count--;
+
+    return res;
+}
+
+/* StateSpells */
+void StateSpells::set(int spell, int turns)
+{
+    duration[spell] = turns;
+
+    if(0 < turns)
+	mask |= 1u << spell;
+    else
+	mask &= ~(1u << spell);
+}
+
+void StateSpells::reduceDuration(void)
+{
+    for(int spell = 0; spell < State::SpellsMax; ++spell)
+	if(isAffected(spell)) set(spell, duration[spell] - 1);
+}
+
+/* StatePlayer */
+int StatePlayer::findCreature(int buid) const
+{
+    for(int it = 0; it < armyCount; ++it)
+	if(army[it].buid == buid) return it;
+
+    return -1;
+}
+
+int StatePlayer::partySize(int land) const
+{
+    return std::count_if(army, army + armyCount, [=](const StateCreature & sc){ return sc.land == land; });
+}
+
+/* GameState */
+GameState GameState::fromSession(const GameSession & gs)
+{
+    GameState res{};
+
+    res.roundWind = gs.roundWind();
+    res.partWind = gs.partWind();
+    res.currentWind = gs.currentWind();
+    res.dropStone = gs.dropStone();
+    res.stoneLastCount = gs.stoneLastCount;
+    res.gamePart = gs.gamePart;
+    res.battleUnitId = gs.battleUnitId;
+    res.owners = gs.landsClan;
+
+    for(auto & stone : gs.croupier.bank)
+	if(res.bankCount < State::WallMax) res.bank[res.bankCount++] = stone();
+
+    for(auto & stone : gs.croupier.trash)
+	if(res.trashCount < State::WallMax) res.trash[res.trashCount++] = stone();
+
+    for(auto & player : gs.gamers)
+    {
+	if(res.playersCount >= State::PlayersMax)
+	    break;
+
+	StatePlayer & sp = res.players[res.playersCount++];
+
+	sp.avatar = player.avatar();
+	sp.clan = player.clan();
+	sp.wind = player.wind();
+	sp.flags = (player.isAI() ? Person::AI : 0) | (player.isCasted() ? Person::Casted : 0) |
+		    (player.adventurePartDone() ? Person::AdventurePartDone : 0);
+	sp.points = player.points;
+
+	for(auto & stone : player.stones)
+	    if(sp.hand.count < State::HandMax) sp.hand.stones[sp.hand.count++] = stoneValue(stone);
+
+	sp.hand.newStone = stoneValue(player.newStone);
+
+	for(auto & rule : player.rules)
+	{
+	    if(sp.hand.rulesCount >= State::RulesMax)
+		break;
+
+	    StateRule & sr = sp.hand.rules[sp.hand.rulesCount++];
+	    sr.rule = rule.rule();
+	    sr.stone = rule.stone()();
+	    sr.flags = (rule.isConcealed() ? State::RuleConcealed : 0) | (rule.isHidden() ? State::RuleHidden : 0);
+	}
+
+	sp.affected = toStateSpells(player.affected);
+
+	for(auto & party : player.army)
+	{
+	    for(auto & bcr : party.toBattleCreatures())
+	    {
+		if(sp.armyCount >= State::CreaturesMax)
+		{
+		    ERROR("army is full" << ", " << "clan: " << player.clan.toString());
+		    break;
+		}
+
+		StateCreature & sc = sp.army[sp.armyCount++];
+
+		sc.buid = bcr->battleUnit();
+		sc.creature = bcr->Creature::id();
+		sc.land = party.land()();
+		sc.target = party.moveTarget()();
+		sc.flags = bcr->isSelected() ? State::CreatureSelected : 0;
+
+		sc.base[State::StatAttack] = bcr->baseAttack();
+		sc.base[State::StatRanger] = bcr->baseRanger();
+		sc.base[State::StatDefense] = bcr->baseDefense();
+		sc.base[State::StatLoyalty] = bcr->baseLoyalty();
+		sc.base[State::StatMove] = bcr->baseMove();
+
+		sc.current[State::StatAttack] = bcr->BattleUnit::attack();
+		sc.current[State::StatRanger] = bcr->BattleUnit::ranger();
+		sc.current[State::StatDefense] = bcr->BattleUnit::defense();
+		sc.current[State::StatLoyalty] = bcr->BattleUnit::loyalty();
+		sc.current[State::StatMove] = bcr->CreatureSkill::freeMovePoint();
+
+		sc.affected = toStateSpells(bcr->affectedSpells());
+	    }
+	}
+    }
+
+    return res;
+}
+
+int GameState::playerOfWind(int wind) const
+{
+    for(int it = 0; it < playersCount; ++it)
+	if(players[it].wind == wind) return it;
+
+    return -1;
+}
+
+int GameState::playerOfClan(int clan) const
+{
+    for(int it = 0; it < playersCount; ++it)
+	if(players[it].clan == clan) return it;
+
+    return -1;
+}
+
+bool GameState::apply(const StateMove & move, StateUndo & res)
+{
+    if(move.type != StateMove::Capture && move.player >= playersCount)
+	return false;
+
+    res.move = move;
+    res.currentWind = currentWind;
+    res.dropStone = dropStone;
+    res.stoneLastCount = stoneLastCount;
+    res.bankCount = bankCount;
+    res.trashCount = trashCount;
+
+    StatePlayer & player = players[move.type != StateMove::Capture ? move.player : 0];
+    res.points = player.points;
+    res.hand = player.hand;
+
+    switch(move.type)
+    {
+	case StateMove::Draw:
+	    if(0 == bankCount || Stone::None != (player.hand.newStone & State::StoneMask))
+		return false;
+
+	    player.hand.newStone = bank[--bankCount];
+	    if(0 < stoneLastCount) stoneLastCount--;
+	    return true;
+
+	case StateMove::Drop:
+	    if(move.arg1 < player.hand.count)
+	    {
+		dropStone = player.hand.del(move.arg1) & State::StoneMask;
+		if(Stone::None != (player.hand.newStone & State::StoneMask))
+		    player.hand.add(player.hand.newStone);
+	    }
+	    else
+	    if(move.arg1 == State::HandMax && Stone::None != (player.hand.newStone & State::StoneMask))
+		dropStone = player.hand.newStone & State::StoneMask;
+	    else
+		return false;
+
+	    player.hand.newStone = Stone::None;
+	    return true;
+
+	case StateMove::Pass:
+	    if(Stone::None != dropStone && trashCount < State::WallMax)
+		trash[trashCount++] = dropStone;
+
+	    dropStone = Stone::None;
+	    currentWind = Wind(static_cast<Wind::wind_t>(currentWind)).next()();
+	    return true;
+
+	case StateMove::Chao:
+	{
+	    // sequence of one suit: arg1, arg1 + 1, arg1 + 2 with the drop stone
+	    const int first = move.arg1;
+
+	    if(Stone::None == dropStone || player.hand.rulesCount >= State::RulesMax ||
+		first < Stone::Skull1 || first > Stone::Number9 || 7 < first % 10 || 0 == first % 10 ||
+		dropStone < first || dropStone > first + 2)
+		return false;
+
+	    for(int stone = first; stone < first + 3; ++stone)
+		if(stone != dropStone && 0 > player.hand.find(stone)) return false;
+
+	    for(int stone = first; stone < first + 3; ++stone)
+		if(stone != dropStone) player.hand.del(player.hand.find(stone));
+
+	    StateRule & rule = player.hand.rules[player.hand.rulesCount++];
+	    rule.rule = WinRule::Chao;
+	    rule.stone = first;
+	    rule.flags = 0;
+
+	    player.points += GameData::bonusChao;
+	    dropStone = Stone::None;
+	    currentWind = player.wind;
+	    return true;
+	}
+
+	case StateMove::Pung:
+	case StateMove::Kong:
+	{
+	    const int need = move.type == StateMove::Pung ? 2 : 3;
+
+	    if(Stone::None == dropStone || player.hand.rulesCount >= State::RulesMax)
+		return false;
+
+	    if(countStone(player.hand, dropStone) < need)
+		return false;
+
+	    for(int it = 0; it < need; ++it)
+		player.hand.del(player.hand.find(dropStone));
+
+	    StateRule & rule = player.hand.rules[player.hand.rulesCount++];
+	    rule.rule = move.type == StateMove::Pung ? WinRule::Pung : WinRule::Kong;
+	    rule.stone = dropStone;
+	    rule.flags = 0;
+
+	    player.points += move.type == StateMove::Pung ? GameData::bonusPung : GameData::bonusKong;
+	    dropStone = Stone::None;
+	    currentWind = player.wind;
+	    return true;
+	}
+
+	case StateMove::Kong2:
+	{
+	    // own turn with the new stone: concealed kong, or upgrade of the open pung
+	    const int stone = player.hand.newStone & State::StoneMask;
+
+	    if(Stone::None == stone)
+		return false;
+
+	    StateRule* pung = std::find_if(player.hand.rules, player.hand.rules + player.hand.rulesCount,
+				[=](const StateRule & sr){ return sr.rule == WinRule::Pung && sr.stone == stone; });
+
+	    if(pung != player.hand.rules + player.hand.rulesCount)
+		pung->rule = WinRule::Kong;
+	    else
+	    if(3 == countStone(player.hand, stone) && player.hand.rulesCount < State::RulesMax)
+	    {
+		for(int it = 0; it < 3; ++it)
+		    player.hand.del(player.hand.find(stone));
+
+		StateRule & rule = player.hand.rules[player.hand.rulesCount++];
+		rule.rule = WinRule::Kong;
+		rule.stone = stone;
+		rule.flags = State::RuleConcealed;
+	    }
+	    else
+		return false;
+
+	    player.hand.newStone = Stone::None;
+	    player.points += GameData::bonusKong;
+	    return true;
+	}
+
+	case StateMove::MoveCreature:
+	{
+	    if(move.arg1 >= player.armyCount)
+		return false;
+
+	    StateCreature & sc = player.army[move.arg1];
+	    if(move.arg3 == 0 || sc.current[State::StatMove] < move.arg3)
+		return false;
+
+	    res.creature = sc;
+	    sc.land = move.arg2;
+	    sc.current[State::StatMove] -= move.arg3;
+	    return true;
+	}
+
+	case StateMove::Capture:
+	    if(move.arg1 >= owners.size())
+		return false;
+
+	    res.owner = owners[move.arg1];
+	    owners[move.arg1] = move.arg2;
+	    return true;
+
+	default: break;
+    }
+
+    return false;
+}
+
+void GameState::undo(const StateUndo & res)
+{
+    const StateMove & move = res.move;
+
+    currentWind = res.currentWind;
+    dropStone = res.dropStone;
+    stoneLastCount = res.stoneLastCount;
+    bankCount = res.bankCount;
+    trashCount = res.trashCount;
+
+    if(move.type == StateMove::Capture)
+    {
+	owners[move.arg1] = res.owner;
+	return;
+    }
+
+    StatePlayer & player = players[move.player];
+    player.points = res.points;
+    player.hand = res.hand;
+
+    if(move.type == StateMove::MoveCreature)
+	player.army[move.arg1] = res.creature;
+}
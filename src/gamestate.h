@@ -0,0 +1,163 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#ifndef _RWNA_GAMESTATE_
+#define _RWNA_GAMESTATE_
+
+#include <cstdint>
+#include <type_traits>
+
+#include "gamedata.h"
+
+/* flat game snapshot for ai lookahead: fixed capacity, copy without allocations */
+namespace State
+{
+    enum { PlayersMax = 4, HandMax = 14, RulesMax = 4, CreaturesMax = 8, WallMax = 136, SpellsMax = Spell::MassDispel + 1 };
+
+    enum { StoneCasted = 0x80, StoneMask = 0x7F };
+
+    enum { RuleConcealed = 0x01, RuleHidden = 0x02 };
+
+    enum { CreatureSelected = 0x01 };
+
+    enum { StatAttack, StatRanger, StatDefense, StatLoyalty, StatMove, StatCount };
+}
+
+struct StateRule
+{
+    uint8_t			rule;
+    uint8_t			stone;
+    uint8_t			flags;
+};
+
+struct StateHand
+{
+    uint8_t			stones[State::HandMax]; // stone id | StoneCasted, sorted
+    uint8_t			count;
+    uint8_t			newStone;
+    StateRule			rules[State::RulesMax];
+    uint8_t			rulesCount;
+
+    int				find(int stone) const;
+    void			add(int stone);
+    int				del(int index);
+};
+
+struct StateSpells
+{
+    uint32_t			mask; // index: Spell::id
+    int8_t			duration[State::SpellsMax];
+
+    bool			isAffected(int spell) const { return mask & (1u << spell); }
+    void			set(int spell, int turns);
+    void			reduceDuration(void);
+};
+
+struct StateCreature
+{
+    int32_t			buid;
+    uint8_t			creature;
+    uint8_t			land;
+    uint8_t			target;
+    uint8_t			flags;
+    int8_t			base[State::StatCount];
+    int8_t			current[State::StatCount];
+    StateSpells			affected;
+
+    bool			isAlive(void) const { return 0 < current[State::StatLoyalty]; }
+};
+
+struct StatePlayer
+{
+    uint8_t			avatar;
+    uint8_t			clan;
+    uint8_t			wind;
+    uint8_t			flags; // Person flags
+    int32_t			points;
+    StateHand			hand;
+    StateSpells			affected;
+    StateCreature		army[State::CreaturesMax];
+    uint8_t			armyCount;
+
+    int				findCreature(int buid) const;
+    int				partySize(int land) const;
+};
+
+struct StateMove
+{
+    enum { None, Draw, Drop, Pass, Chao, Pung, Kong, Kong2, MoveCreature, Capture };
+
+    uint8_t			type;
+    uint8_t			player;
+    uint8_t			arg1; // drop: hand index, HandMax: new stone; chao: first stone; move: army slot; capture: land
+    uint8_t			arg2; // move: land; capture: clan
+    uint8_t			arg3; // move: steps
+
+    StateMove() : type(None), player(0), arg1(0), arg2(0), arg3(0) {}
+    StateMove(int t, int p, int a1 = 0, int a2 = 0, int a3 = 0) : type(t), player(p), arg1(a1), arg2(a2), arg3(a3) {}
+};
+
+/* saved values of one applied move */
+struct StateUndo
+{
+    StateMove			move;
+    uint8_t			currentWind;
+    uint8_t			dropStone;
+    uint8_t			stoneLastCount;
+    uint8_t			bankCount;
+    uint8_t			trashCount;
+    uint8_t			owner;
+    int32_t			points;
+    StateHand			hand;
+    StateCreature		creature;
+};
+
+struct GameState
+{
+    uint8_t			roundWind;
+    uint8_t			partWind;
+    uint8_t			currentWind;
+    uint8_t			dropStone;
+    uint8_t			stoneLastCount;
+    uint8_t			gamePart;
+    uint8_t			bankCount;
+    uint8_t			trashCount;
+    int32_t			battleUnitId;
+    uint8_t			bank[State::WallMax]; // draw from back
+    uint8_t			trash[State::WallMax];
+    StatePlayer			players[State::PlayersMax];
+    uint8_t			playersCount;
+    LandOwners			owners;
+
+    static GameState		fromSession(const GameSession &);
+
+    int				playerOfWind(int wind) const;
+    int				playerOfClan(int clan) const;
+
+    bool			apply(const StateMove &, StateUndo &);
+    void			undo(const StateUndo &);
+};
+
+static_assert(std::is_trivially_copyable<GameState>::value, "GameState: trivially copyable");
+
+#endif
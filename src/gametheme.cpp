@@ -42,6 +42,7 @@ namespace GameTheme
     StringList				shareDirs;
 
     std::string				themeName;
+    std::string				themeDir;
     std::string				themeDescription;
     std::string				themeAuthor;
     Size				themeSize;
@@ -94,6 +95,8 @@ void GameTheme::clear(void)
 
 bool GameTheme::loadResources(const Application & app)
 {
+    themeDir = app.theme;
+
 #if defined(ANDROID)
     const char* list = "assets.list";
     std::string str;
@@ -217,6 +220,37 @@ bool GameTheme::init(const Application & app)
     return true;
 }
 
+bool GameTheme::initHeadless(const Application & app, bool compiled)
+{
+    // game data only: without display, fonts and sprites (benchmarks, simulations)
+    themeName = app.theme;
+
+    if(! loadResources(app))
+	return false;
+
+    JsonObject jo = jsonResource("index.json").toObject();
+
+    if(! jo.isValid())
+    {
+        ERROR("index.json not found, theme: " << app.theme);
+        return false;
+    }
+
+    themeName = jo.getString("name");
+    themeDescription = jo.getString("description");
+    themeAuthor = jo.getString("author");
+    themeSize = JsonUnpack::size(jo, "size");
+
+    if(! GameData::init(jo, compiled))
+    {
+	ERROR("game data init: error");
+        return false;
+    }
+
+    VERBOSE("use theme: " << themeName << ", " << "author: " << themeAuthor << ", " << "headless");
+    return true;
+}
+
 const JsonToolTip & GameTheme::jsonToolTipInfo(void)
 {
     return themeTooltips;
@@ -283,6 +317,23 @@ bool GameTheme::findResource(const std::string & filename, std::string* res)
     return false;
 }
 
+bool GameTheme::findCompiled(const std::string & filename, std::string* res)
+{
+#ifdef RWNA_ASSETS_DIR
+    // build tree: assets compiled by the build, copies in the theme dir are ignored
+    const std::string path = Systems::concatePath(Systems::concatePath(RWNA_ASSETS_DIR, themeDir), filename);
+
+    if(! Systems::isFile(path))
+	return false;
+
+    if(res) res->assign(path);
+    return true;
+#else
+    // installed or packed theme: compiled assets next to the jsons
+    return findResource(filename, res);
+#endif
+}
+
 JsonContent GameTheme::jsonResource(const std::string & filename)
 {
     JsonContent res;
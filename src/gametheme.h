@@ -31,6 +31,7 @@ struct Application;
 namespace GameTheme
 {
     bool		init(const Application &);
+    bool		initHeadless(const Application &, bool compiled = true);
     void		clear(void);
 
     const std::string & name(void);
@@ -39,6 +40,7 @@ namespace GameTheme
 
     const BinaryBuf &   readResource(const std::string &, std::string* res = nullptr);
     bool                findResource(const std::string &, std::string* res = nullptr);
+    bool                findCompiled(const std::string &, std::string* res = nullptr);
     JsonContent         jsonResource(const std::string &);
 
     const FontRender &	fontRender(const std::string &);
@@ -0,0 +1,269 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include <cstring>
+#include <algorithm>
+
+#include "gamedata.h"
+#include "landmap.h"
+
+static_assert(LandMap::LandsCount <= 64, "borders: one bit by land");
+
+namespace
+{
+    const char landMapMagic[4] = { 'R', 'W', 'L', 'M' };
+
+    // even odd rule, pixel centers on integer coordinates
+    bool polygonInside(const Points & points, int px, int py)
+    {
+	bool res = false;
+
+	for(size_t it = 0, prev = points.size() - 1; it < points.size(); prev = it++)
+	{
+	    const Point & pt1 = points[it];
+	    const Point & pt2 = points[prev];
+
+	    if((pt1.y > py) != (pt2.y > py) &&
+		px < pt1.x + (py - pt1.y) * static_cast<double>(pt2.x - pt1.x) / (pt2.y - pt1.y))
+		res = ! res;
+	}
+
+	return res;
+    }
+}
+
+LandMap::LandMap() : header(nullptr), raster(nullptr)
+{
+}
+
+bool LandMap::attach(uint32_t source)
+{
+    const uint8_t* data = file.data();
+    const size_t size = file.size();
+    const Header* hdr = reinterpret_cast<const Header*>(data);
+
+    header = nullptr;
+    raster = nullptr;
+
+    if(size < sizeof(Header) || 0 != std::memcmp(hdr->magic, landMapMagic, sizeof(landMapMagic)))
+    {
+	ERROR("unknown format");
+	return false;
+    }
+
+    if(hdr->version != Version || hdr->size != sizeof(Header) || hdr->lands != LandsCount)
+    {
+	ERROR("other version: " << hdr->version << ", " << "lands: " << hdr->lands);
+	return false;
+    }
+
+    if(hdr->source != source)
+    {
+	VERBOSE("outdated, lands.json changed");
+	return false;
+    }
+
+    if(size < sizeof(Header) + static_cast<size_t>(hdr->width) * hdr->height)
+    {
+	ERROR("raster truncated");
+	return false;
+    }
+
+    header = hdr;
+    raster = data + sizeof(Header);
+    return true;
+}
+
+bool LandMap::load(const std::string & path, uint32_t source)
+{
+    if(file.load(path) && attach(source))
+	return true;
+
+    file.release();
+    return false;
+}
+
+bool LandMap::assign(std::vector<uint8_t> && blob, uint32_t source)
+{
+    file.assign(std::move(blob));
+
+    if(attach(source))
+	return true;
+
+    file.release();
+    return false;
+}
+
+bool LandMap::isBorders(const Land & land1, const Land & land2) const
+{
+    return header->borders[land1()] & (1ULL << land2());
+}
+
+int LandMap::hops(const Land & from, const Land & to) const
+{
+    return header->hops[from()][to()];
+}
+
+Rect LandMap::bounds(const Land & land) const
+{
+    const int16_t* rt = header->bounds[land()];
+    return Rect(rt[0], rt[1], rt[2], rt[3]);
+}
+
+Land LandMap::landAt(const Point & pos) const
+{
+    if(0 > pos.x || 0 > pos.y || pos.x >= static_cast<int>(header->width) || pos.y >= static_cast<int>(header->height))
+	return Land();
+
+    return Land(static_cast<Land::land_t>(raster[pos.y * header->width + pos.x]));
+}
+
+bool LandMap::compile(const std::vector<const LandInfo*> & lands, uint32_t source, std::vector<uint8_t> & blob)
+{
+    Header hdr;
+    std::memset(& hdr, 0, sizeof(hdr));
+    std::memcpy(hdr.magic, landMapMagic, sizeof(landMapMagic));
+
+    hdr.version = Version;
+    hdr.size = sizeof(Header);
+    hdr.lands = LandsCount;
+    hdr.source = source;
+
+    bool res = true;
+    uint64_t present = 0;
+
+    for(auto & info : lands)
+    {
+	const int id = info->id();
+
+	if(0 >= id || LandsCount <= id || (present & (1ULL << id)))
+	{
+	    ERROR("land id error: " << info->id.toString());
+	    return false;
+	}
+
+	present |= 1ULL << id;
+
+	for(auto & border : info->borders)
+	{
+	    if(! border.isValid() || LandsCount <= border() || border == info->id)
+	    {
+		ERROR("land border error: " << info->id.toString() << "->" << border.toString());
+		res = false;
+	    }
+	    else
+		hdr.borders[id] |= 1ULL << border();
+	}
+
+	if(3 > info->points.size())
+	{
+	    ERROR("land polygon error: " << info->id.toString());
+	    res = false;
+	}
+	else
+	if(! polygonInside(info->points, info->center.x, info->center.y))
+	{
+	    ERROR("land center outside polygon: " << info->id.toString());
+	    res = false;
+	}
+    }
+
+    if(! res || lands.empty())
+	return false;
+
+    // symmetric borders
+    for(auto & info : lands)
+	for(int id = 0; id < LandsCount; ++id)
+	    if((hdr.borders[info->id()] & (1ULL << id)) && ! (hdr.borders[id] & (1ULL << info->id())))
+    {
+	ERROR("land path error: " << info->id.toString() << "<->" << Land(static_cast<Land::land_t>(id)).toString());
+	res = false;
+    }
+
+    // all pairs: breadth first by land
+    std::memset(hdr.hops, Unreachable, sizeof(hdr.hops));
+
+    for(auto & info : lands)
+    {
+	uint8_t* row = hdr.hops[info->id()];
+	std::vector<int> wave = { info->id() };
+
+	row[info->id()] = 0;
+
+	for(size_t it = 0; it < wave.size(); ++it)
+	    for(int id = 0; id < LandsCount; ++id)
+		if((hdr.borders[wave[it]] & (1ULL << id)) && row[id] == Unreachable)
+	    {
+		row[id] = row[wave[it]] + 1;
+		wave.push_back(id);
+	    }
+
+	if(wave.size() != lands.size())
+	{
+	    ERROR("lands graph not connected: " << info->id.toString() << ", " << "reached: " << wave.size());
+	    res = false;
+	}
+    }
+
+    if(! res)
+	return false;
+
+    // polygon bounds
+    for(auto & info : lands)
+    {
+	auto minx = std::minmax_element(info->points.begin(), info->points.end(), [](const Point & pt1, const Point & pt2){ return pt1.x < pt2.x; });
+	auto miny = std::minmax_element(info->points.begin(), info->points.end(), [](const Point & pt1, const Point & pt2){ return pt1.y < pt2.y; });
+	int16_t* rt = hdr.bounds[info->id()];
+
+	if(0 > (*minx.first).x || 0 > (*miny.first).y || INT16_MAX <= (*minx.second).x || INT16_MAX <= (*miny.second).y)
+	{
+	    ERROR("land polygon out of map: " << info->id.toString());
+	    return false;
+	}
+
+	rt[0] = (*minx.first).x;
+	rt[1] = (*miny.first).y;
+	rt[2] = (*minx.second).x - (*minx.first).x + 1;
+	rt[3] = (*miny.second).y - (*miny.first).y + 1;
+
+	hdr.width = std::max(hdr.width, static_cast<uint32_t>(rt[0] + rt[2]));
+	hdr.height = std::max(hdr.height, static_cast<uint32_t>(rt[1] + rt[3]));
+    }
+
+    blob.assign(sizeof(Header) + static_cast<size_t>(hdr.width) * hdr.height, 0);
+    std::memcpy(blob.data(), & hdr, sizeof(Header));
+
+    // hit test raster: shared edges go to the later land, as the later window is on top
+    uint8_t* pixels = blob.data() + sizeof(Header);
+
+    for(auto & info : lands)
+    {
+	const int16_t* rt = hdr.bounds[info->id()];
+
+	for(int py = rt[1]; py < rt[1] + rt[3]; ++py)
+	    for(int px = rt[0]; px < rt[0] + rt[2]; ++px)
+		if(polygonInside(info->points, px, py)) pixels[py * hdr.width + px] = info->id();
+    }
+
+    return true;
+}
@@ -0,0 +1,82 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#ifndef _RWNA_LANDMAP_
+#define _RWNA_LANDMAP_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "gameobjects.h"
+#include "mappedfile.h"
+
+struct LandInfo;
+
+/* land graph and geometry compiled from lands.json: adjacency, distances, bounds and hit test raster */
+class LandMap
+{
+public:
+    enum { Version = 1, LandsCount = Land::SiphonsChute + 1, Unreachable = 0xFF };
+
+    /* file layout, native byte order: raster of width * height land ids follows */
+    struct Header
+    {
+	char			magic[4];
+	uint32_t		version;
+	uint32_t		size; /* sizeof(Header) */
+	uint32_t		lands;
+	uint32_t		source; /* lands.json size and time */
+	uint32_t		width;
+	uint32_t		height;
+	uint64_t		borders[LandsCount];
+	uint8_t			hops[LandsCount][LandsCount];
+	int16_t			bounds[LandsCount][4];
+    };
+
+protected:
+    MappedFile			file;
+    const Header*		header;
+    const uint8_t*		raster;
+
+    bool			attach(uint32_t source);
+
+public:
+    LandMap();
+
+    /* mmap of compiled file, false: absent, stale or other layout */
+    bool			load(const std::string & path, uint32_t source);
+    bool			assign(std::vector<uint8_t> &&, uint32_t source);
+
+    bool			isValid(void) const { return header; }
+
+    bool			isBorders(const Land &, const Land &) const;
+    int				hops(const Land &, const Land &) const;
+    Rect			bounds(const Land &) const;
+    Land			landAt(const Point &) const;
+
+    /* validate lands and build the file, errors to log */
+    static bool			compile(const std::vector<const LandInfo*> &, uint32_t source, std::vector<uint8_t> &);
+};
+
+#endif
@@ -377,7 +377,7 @@ bool MahjongPartScreen::checkCastInformer(void) const
     {
         const SpellInfo & spellInfo = GameData::spellInfo(*it);
         if(spellInfo.stones.size() && ld.myPlayer().points >= spellInfo.cost &&
-	    ld.myPlayer().stones.allowCast(spellInfo.stones, ld.myPlayer().newStone))
+	    ld.myPlayer().allowCastRunes(spellInfo.id))
 	    return true;
     }
 
@@ -385,7 +385,7 @@ bool MahjongPartScreen::checkCastInformer(void) const
     {
         const CreatureInfo & creatureInfo = GameData::creatureInfo(*it);
         if(creatureInfo.stones.size() && ld.myPlayer().points >= creatureInfo.cost &&
-	    ld.myPlayer().stones.allowCast(creatureInfo.stones, ld.myPlayer().newStone))
+	    ld.myPlayer().allowSummonRunes(creatureInfo.id))
 	    return true;
     }
 
@@ -1120,10 +1120,10 @@ void MahjongPartScreen::renderScryRunes(void)
     }
 
     if(ld.remoteLeft().isAffectedSpell(Spell::ScryRunes))
-	renderScryVertical(ld.remoteLeft().stones, namesPos.left);
+	renderScryVertical(ld.remoteLeft().stones.toStones(), namesPos.left);
 
     if(ld.remoteRight().isAffectedSpell(Spell::ScryRunes))
-	renderScryVertical(ld.remoteRight().stones, namesPos.right);
+	renderScryVertical(ld.remoteRight().stones.toStones(), namesPos.right);
 }
 
 void MahjongPartScreen::renderScryVertical(const Stones & stones, const Point & center)
@@ -20,7 +20,6 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
  ***************************************************************************/
 
-#include <numeric>
 #include <algorithm>
 
 #include "settings.h"
@@ -54,10 +53,7 @@ MahjongSummaryPartScreen::MahjongSummaryPartScreen() : JsonWindow("screen_mahjon
     luck1Sprite = GameTheme::jsonSprite(jobject, "sprite:luck1");
     luck2Sprite = GameTheme::jsonSprite(jobject, "sprite:luck2");
 
-    runeBonusList = ld.winResult.bonusRunes();
-    doubleBonusList = ld.winResult.bonusDoubles();
-    handBonusList = ld.winResult.bonusHands();
-    opponentFinesList = ld.winResult.opponentFines();
+    score = ld.winResult.breakdown();
 
     const Wind & winWind = ld.winResult.winWind;
     const Wind & dealWind = ld.winResult.dealWind;
@@ -90,8 +86,7 @@ MahjongSummaryPartScreen::MahjongSummaryPartScreen() : JsonWindow("screen_mahjon
 
     labels.push_back(GameTheme::jsonTextInfo(jobject, "textinfo:drawn"));
 
-    bool selfDrawnHand = std::any_of(handBonusList.begin(), handBonusList.end(),
-				[](const HandBonus & bonus){ return bonus.isType(HandBonus::SelfDrawn); });
+    bool selfDrawnHand = score.isHand(HandBonus::SelfDrawn);
 
     if(ld.winResult.isDrawn())
 	labels.back().text = _("Game Drawn");
@@ -149,8 +144,7 @@ MahjongSummaryPartScreen::MahjongSummaryPartScreen() : JsonWindow("screen_mahjon
     if(buttonNext)
 	buttonNext->setAction(Action::ButtonDone);
 
-    int doubles = std::accumulate(doubleBonusList.begin(), doubleBonusList.end(), 0,
-				    [](int v, const DoubleBonus & bonus){ return v + bonus.value(); });
+    int doubles = score.totalDoubles;
     if(doubles > 4)
     {
 	multiplier = 16;
@@ -159,7 +153,7 @@ MahjongSummaryPartScreen::MahjongSummaryPartScreen() : JsonWindow("screen_mahjon
     else
     {
 	multiplier = doubles;
-	totalScore = ld.winResult.totalPoints() * multiplier;
+	totalScore = score.totalPoints * multiplier;
     }
 
     setVisible(true);
@@ -189,8 +183,9 @@ void MahjongSummaryPartScreen::renderWinStones(void)
 	JsonTextInfo bonusText = pointsText;
 
 	// rules
-	for(auto & runeBonus : runeBonusList)
+	for(int it = 0; it < score.runesCount; ++it)
 	{
+	    const RuneBonus & runeBonus = score.runes[it];
 	    const Stones & stones = runeBonus.stones();
 	    int sph = 0;
 
@@ -221,12 +216,13 @@ void MahjongSummaryPartScreen::renderWinStones(void)
 
 	// base score
 	Rect rt = renderTextInfo(baseScoreText, _("Base Score:"));
-	renderTextInfo(baseScoreText, String::number(ld.winResult.baseScore()), Point(pointsText.position.x, baseScoreText.position.y), AlignRight);
+	renderTextInfo(baseScoreText, String::number(score.baseScore), Point(pointsText.position.x, baseScoreText.position.y), AlignRight);
 
 	pos = baseScoreText.position + Point(0, rt.h + 10);
 
-	for(auto & handBonus : handBonusList)
+	for(int it = 0; it < score.handsCount; ++it)
 	{
+	    const HandBonus & handBonus = score.hands[it];
 	    DEBUG("hand: " << handBonus.name() << ", " << handBonus.value());
 	    renderTextInfo(baseScoreText, handBonus.name(), pos, AlignLeft);
 	    renderTextInfo(baseScoreText, String::number(handBonus.value()), Point(pointsText.position.x, pos.y), AlignRight);
@@ -235,14 +231,15 @@ void MahjongSummaryPartScreen::renderWinStones(void)
 
 	// total points
 	renderTextInfo(totalPointsText, _("Total Points:"));
-	renderTextInfo(totalPointsText, String::number(ld.winResult.totalPoints()), Point(pointsText.position.x, totalPointsText.position.y), AlignRight);
+	renderTextInfo(totalPointsText, String::number(score.totalPoints), Point(pointsText.position.x, totalPointsText.position.y), AlignRight);
 
 	// double score
 	rt = renderTextInfo(doublesText, _("Doubles:"));
 	pos = doublesText.position + Point(0, rt.h + 10);
 
-	for(auto & doubleBonus : doubleBonusList)
+	for(int it = 0; it < score.doublesCount; ++it)
 	{
+	    const DoubleBonus & doubleBonus = score.doubles[it];
 	    Rect textpos = renderTextInfo(doublesText, doubleBonus.name(), pos, AlignLeft);
 	    renderTextInfo(doublesText, String::number(doubleBonus.value()), Point(width() - doublesOffset.x, pos.y), AlignRight);
 
@@ -256,8 +253,9 @@ void MahjongSummaryPartScreen::renderWinStones(void)
 	pos = finesText.position;
 
 	if(0 < totalScore)
-	for(auto & opponentFine : opponentFinesList)
+	for(int it = 0; it < score.finesCount; ++it)
 	{
+	    const OpponentFine & opponentFine = score.fines[it];
 	    const std::string & loseAvatarName = GameData::avatarInfo(ld.playerOfWind(opponentFine.wind()).avatar).name;
 	    int winsValue = totalScore * opponentFine.value();
 
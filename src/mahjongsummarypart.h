@@ -36,10 +36,7 @@ class MahjongSummaryPartScreen : public JsonWindow
     int			multiplier;
     int			totalScore;
 
-    RuneBonusList	runeBonusList;
-    DoubleBonusList	doubleBonusList;
-    HandBonusList	handBonusList;
-    OpponentFinesList	opponentFinesList;
+    ScoreBreakdown	score;
 
     Texture		markLeftSprite;
     Texture		markRightSprite;
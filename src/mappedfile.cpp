@@ -0,0 +1,127 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#if defined(__unix__) && ! defined(ANDROID)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define MAPPEDFILE_MMAP
+#endif
+
+#include "libswe.h"
+#include "mappedfile.h"
+
+using namespace SWE;
+
+MappedFile::MappedFile() : ptr(nullptr), len(0), mapped(nullptr)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    release();
+}
+
+void MappedFile::release(void)
+{
+#ifdef MAPPEDFILE_MMAP
+    if(mapped)
+	::munmap(mapped, len);
+#endif
+
+    ptr = nullptr;
+    len = 0;
+    mapped = nullptr;
+    buffer.clear();
+}
+
+bool MappedFile::load(const std::string & path)
+{
+    release();
+
+#ifdef MAPPEDFILE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(0 > fd)
+	return false;
+
+    struct stat st;
+
+    if(0 == ::fstat(fd, & st) && 0 < st.st_size)
+    {
+	void* res = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	if(res != MAP_FAILED)
+	{
+	    mapped = res;
+	    ptr = static_cast<const uint8_t*>(res);
+	    len = st.st_size;
+	}
+    }
+
+    ::close(fd);
+    return mapped;
+#else
+    const BinaryBuf buf = Systems::readFile(path);
+    assign(std::vector<uint8_t>(buf.data(), buf.data() + buf.size()));
+    return len;
+#endif
+}
+
+void MappedFile::assign(std::vector<uint8_t> && blob)
+{
+    release();
+    buffer = std::move(blob);
+
+    ptr = buffer.data();
+    len = buffer.size();
+}
+
+uint32_t MappedFile::checksum(const uint8_t* data, size_t size, uint32_t seed)
+{
+    uint32_t res = seed;
+
+    for(size_t it = 0; it < size; ++it)
+    {
+	res ^= data[it];
+	res *= 16777619u;
+    }
+
+    return res;
+}
+
+bool MappedFile::stamp(const std::string & path, uint32_t & seed)
+{
+#ifdef MAPPEDFILE_MMAP
+    struct stat st;
+
+    if(0 != ::stat(path.c_str(), & st))
+	return false;
+
+    const int64_t fields[] = { static_cast<int64_t>(st.st_size), static_cast<int64_t>(st.st_mtime) };
+    seed = checksum(reinterpret_cast<const uint8_t*>(fields), sizeof(fields), seed);
+    return true;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,59 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#ifndef _RWNA_MAPPEDFILE_
+#define _RWNA_MAPPEDFILE_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+/* read only image of compiled asset: mmap where available, else read to memory */
+class MappedFile
+{
+    const uint8_t*		ptr;
+    size_t			len;
+    void*			mapped;
+    std::vector<uint8_t>	buffer;
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &		operator= (const MappedFile &) = delete;
+
+    bool			load(const std::string &);
+    void			assign(std::vector<uint8_t> &&);
+    void			release(void);
+
+    const uint8_t*		data(void) const { return ptr; }
+    size_t			size(void) const { return len; }
+
+    /* fnv-1a, seed: previous sum for chain */
+    static uint32_t		checksum(const uint8_t*, size_t, uint32_t seed = 2166136261u);
+    /* fnv-1a of file size and modification time, false: without file system */
+    static bool			stamp(const std::string &, uint32_t & seed);
+};
+
+#endif
@@ -66,28 +66,6 @@ public:
     GameLoadScreen(const std::string & file) : DisplayWindow(Color::Black), savefile(file) {}
 };
 
-std::string Application::domain(void)
-{
-    return "runewars-na";
-}
-
-std::string Application::name(void)
-{
-    return "RuneWars: New Age";
-}
-
-std::string Application::version(void)
-{
-    std::string version;
-#ifdef BUILDDATE
-    version.append(BUILDDATE);
- #ifdef SRCREVISION
-    version.append(".").append(SRCREVISION);
- #endif
-#endif
-    return version;
-}
-
 RuneWarsClient::RuneWarsClient(int argc, char** argv) : Application(argv[0], false, Size(0, 0), "default"), part(0)
 {
     LogWrapper::init(domain(), argv[0]);
@@ -0,0 +1,270 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include <cstring>
+#include <algorithm>
+
+#include "gameobjects.h"
+#include "scoretable.h"
+
+namespace
+{
+    struct NameId
+    {
+	const char*	name;
+	int		id;
+    };
+
+    const NameId featureNames[] = {
+	{ "set:pung", Score::SetPung }, { "set:kong", Score::SetKong }, { "set:chao", Score::SetChao },
+	{ "set:outer", Score::SetOuter }, { "set:concealed", Score::SetConcealed },
+	{ "pair:dragon", Score::PairDragon }, { "pair:wind", Score::PairWind }, { "pair:terminal", Score::PairTerminal },
+	{ "pair:honor", Score::PairHonor }, { "pair:lucky", Score::PairLucky }, { "pair:last", Score::PairLast },
+	{ "pair:round_wind", Score::PairRoundWind }, { "pair:win_wind", Score::PairWinWind },
+	{ "sets:dragon", Score::SetsDragon }, { "sets:wind", Score::SetsWind }, { "sets:lucky", Score::SetsLucky },
+	{ "sets:chao", Score::SetsChao }, { "sets:concealed", Score::SetsConcealed }, { "sets:concealed_triplets", Score::SetsConcealedTriplets },
+	{ "sets:terminal", Score::SetsTerminal }, { "sets:honor", Score::SetsHonor }, { "sets:terminal_honor", Score::SetsTerminalHonor },
+	{ "sets:ordered_suit", Score::SetsOrderedSuit }, { "sets:one_chance", Score::SetsOneChance },
+	{ "hand:no_points", Score::HandNoPoints }, { "hand:self_drawn", Score::HandSelfDrawn },
+	{ "hand:concealed_discard", Score::HandConcealedDiscard }, { "hand:one_suit", Score::HandOneSuit },
+	{ "hand:one_suit_honors", Score::HandOneSuitHonors } };
+
+    const NameId handNames[] = {
+	{ "one_chance", HandBonus::OneChance }, { "self_drawn", HandBonus::SelfDrawn },
+	{ "all_concealed_with_discard", HandBonus::AllConcealedWithDiscard } };
+
+    const NameId doubleNames[] = {
+	{ "lucky_sets", DoubleBonus::LuckySets }, { "one_suit_honors", DoubleBonus::OneSuitHonors }, { "no_points", DoubleBonus::NoPoints },
+	{ "four_triplets", DoubleBonus::FourTriplets }, { "terminals_honors", DoubleBonus::TerminalsHonors },
+	{ "terminal_honor_each_set", DoubleBonus::TerminalHonorEachSet }, { "all_simples", DoubleBonus::AllSimples },
+	{ "three_little_dragons", DoubleBonus::ThreeLittleDragons }, { "one_suit_only", DoubleBonus::OneSuitOnly },
+	{ "three_consecutive_sequences", DoubleBonus::ThreeConsecutiveSequences }, { "all_concealed_self_drawn", DoubleBonus::AllConcealedSelfDrawn },
+	{ "last_tile_wall", DoubleBonus::LastTileWall }, { "three_concealed_triplets", DoubleBonus::ThreeConcealedTriplets },
+	{ "robbed_kong", DoubleBonus::RobbedKong }, { "supplemental_tile", DoubleBonus::SupplementalTile },
+	{ "three_big_dragons", DoubleBonus::ThreeBigDragons }, { "big_four_winds", DoubleBonus::BigFourWinds },
+	{ "all_terminals", DoubleBonus::AllTerminals }, { "all_honors", DoubleBonus::AllHonors }, { "nine_gates", DoubleBonus::NineGates },
+	{ "heavenly_hand", DoubleBonus::HeavenlyHand }, { "four_concealed_triplets", DoubleBonus::FourConcealedTriplets },
+	{ "thirteen_orphans", DoubleBonus::ThirteenOrphans }, { "little_four_winds", DoubleBonus::LittleFourWinds },
+	{ "earthly_hand", DoubleBonus::EarthlyHand } };
+
+    template<size_t N>
+    int findName(const NameId (&names)[N], const std::string & name)
+    {
+	auto it = std::find_if(std::begin(names), std::end(names),
+			[&](const NameId & val){ return 0 == std::strcmp(val.name, name.c_str()); });
+	return it != std::end(names) ? (*it).id : -1;
+    }
+
+    const char* sectionNames[] = { "runes", "pair", "hands", "doubles" };
+
+    const int ScoreValueMin = -0x7FFF;
+    const int ScoreValueMax = 0x7FFF;
+}
+
+ScoreTable::ScoreTable() : baseScore(20), limitScore(500)
+{
+    sections.fill(std::make_pair(0, 0));
+}
+
+bool ScoreTable::compileTerm(const std::string & str, ScoreTerm & term) const
+{
+    // "feature op value"
+    StringList list = String::split(String::trimmed(str), 0x20);
+    list.remove("");
+
+    if(list.size() != 3)
+    {
+	ERROR("incorrect term: " << str);
+	return false;
+    }
+
+    auto it = list.begin();
+    const std::string & name = *it++;
+    const std::string & op = *it++;
+    int value = String::toInt(*it);
+
+    int feature = findName(featureNames, name);
+    if(0 > feature)
+    {
+	ERROR("unknown feature: " << name);
+	return false;
+    }
+
+    int min = value;
+    int max = value;
+    term.negate = false;
+
+    if(op == "==") {}
+    else
+    if(op == "!=") term.negate = true;
+    else
+    if(op == "<") { min = ScoreValueMin; max = value - 1; }
+    else
+    if(op == "<=") min = ScoreValueMin;
+    else
+    if(op == ">") { min = value + 1; max = ScoreValueMax; }
+    else
+    if(op == ">=") max = ScoreValueMax;
+    else
+    {
+	ERROR("unknown operator: " << op);
+	return false;
+    }
+
+    term.feature = feature;
+    term.min = min;
+    term.range = max - min;
+
+    return true;
+}
+
+bool ScoreTable::compileSection(int section, const JsonArray & ja, StringList & groups)
+{
+    sections[section].first = rules.size();
+
+    for(int it = 0; it < ja.size(); ++it)
+    {
+	const JsonObject* jo = ja.getObject(it);
+	if(! jo) continue;
+
+	ScoreRule rule;
+
+	rule.bonus = 0;
+	rule.value = jo->getInteger("value", 0);
+	rule.valueFeature = Score::FeatureNone;
+	rule.group = 0;
+
+	if(section == Score::Hands || section == Score::Doubles)
+	{
+	    const std::string bonus = jo->getString("bonus");
+	    rule.bonus = section == Score::Hands ? findName(handNames, bonus) : findName(doubleNames, bonus);
+
+	    if(0 > rule.bonus)
+	    {
+		ERROR("unknown bonus: " << bonus);
+		return false;
+	    }
+	}
+
+	if(jo->hasKey("value:feature"))
+	{
+	    const std::string name = jo->getString("value:feature");
+	    int feature = findName(featureNames, name);
+
+	    if(0 > feature)
+	    {
+		ERROR("unknown feature: " << name);
+		return false;
+	    }
+
+	    rule.valueFeature = feature;
+	}
+
+	if(section == Score::Runes || section == Score::Pair)
+	    rule.group = Score::FirstMatch;
+	else
+	if(jo->hasKey("group"))
+	{
+	    const std::string group = jo->getString("group");
+	    auto itg = std::find(groups.begin(), groups.end(), group);
+	    int index = std::distance(groups.begin(), itg);
+
+	    if(itg == groups.end())
+	    {
+		if(31 <= groups.size())
+		{
+		    ERROR("too many groups: " << group);
+		    return false;
+		}
+		groups.push_back(group);
+	    }
+
+	    rule.group = 1 << index;
+	}
+
+	rule.termsBegin = terms.size();
+
+	for(auto & str : jo->getStdList<std::string>("when"))
+	{
+	    ScoreTerm term;
+	    if(! compileTerm(str, term))
+		return false;
+	    terms.push_back(term);
+	}
+
+	rule.termsEnd = terms.size();
+	rules.push_back(rule);
+    }
+
+    sections[section].second = rules.size();
+    return true;
+}
+
+bool ScoreTable::load(const JsonObject & jo)
+{
+    StringList groups;
+
+    terms.clear();
+    rules.clear();
+    sections.fill(std::make_pair(0, 0));
+
+    baseScore = jo.getInteger("score:base", 20);
+    limitScore = jo.getInteger("score:limit", 500);
+
+    for(int section = 0; section < Score::SectionCount; ++section)
+    {
+	const JsonArray* ja = jo.getArray(sectionNames[section]);
+
+	if(! ja)
+	{
+	    ERROR("scoring section not found: " << sectionNames[section]);
+	    return false;
+	}
+
+	if(! compileSection(section, *ja, groups))
+	    return false;
+    }
+
+    DEBUG("scoring rules: " << rules.size() << ", terms: " << terms.size());
+    return true;
+}
+
+bool ScoreTable::match(const ScoreRule & rule, const ScoreFeatures & features) const
+{
+    bool res = true;
+
+    for(int it = rule.termsBegin; it < rule.termsEnd; ++it)
+    {
+	const ScoreTerm & term = terms[it];
+	res &= (static_cast<uint32_t>(features[term.feature] - term.min) <= term.range) != term.negate;
+    }
+
+    return res;
+}
+
+int ScoreTable::value(int section, const ScoreFeatures & features) const
+{
+    int res = 0;
+    apply(section, features, [&](int bonus, int value){ res = value; });
+    return res;
+}
@@ -0,0 +1,118 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#ifndef _RWNA_SCORETABLE_
+#define _RWNA_SCORETABLE_
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include "libswe.h"
+
+using namespace SWE;
+
+/* scoring rules from scoring.json, compiled to range tests over a hand feature vector */
+namespace Score
+{
+    enum section_t { Runes, Pair, Hands, Doubles, SectionCount };
+
+    enum feature_t {
+	// current set
+	SetPung, SetKong, SetChao, SetOuter, SetConcealed,
+	// pair stone
+	PairDragon, PairWind, PairTerminal, PairHonor, PairLucky, PairLast, PairRoundWind, PairWinWind,
+	// all sets
+	SetsDragon, SetsWind, SetsLucky, SetsChao, SetsConcealed, SetsConcealedTriplets, SetsTerminal, SetsHonor,
+	SetsTerminalHonor, SetsOrderedSuit, SetsOneChance,
+	// hand
+	HandNoPoints, HandSelfDrawn, HandConcealedDiscard, HandOneSuit, HandOneSuitHonors,
+	FeatureCount };
+
+    enum { FeatureNone = 0xFF, FirstMatch = 0x80000000 };
+}
+
+typedef std::array<int, Score::FeatureCount> ScoreFeatures;
+
+struct ScoreTerm
+{
+    uint8_t			feature;
+    bool			negate;
+    int				min;
+    uint32_t			range; // max - min
+};
+
+struct ScoreRule
+{
+    int				bonus;
+    int				value;
+    uint8_t			valueFeature;
+    uint32_t			group;
+    uint16_t			termsBegin;
+    uint16_t			termsEnd;
+};
+
+class ScoreTable
+{
+    std::vector<ScoreTerm>	terms;
+    std::vector<ScoreRule>	rules;
+    std::array<std::pair<int, int>, Score::SectionCount> sections;
+
+    int				baseScore;
+    int				limitScore;
+
+    bool			match(const ScoreRule &, const ScoreFeatures &) const;
+    bool			compileSection(int section, const JsonArray &, StringList & groups);
+    bool			compileTerm(const std::string &, ScoreTerm &) const;
+
+public:
+    ScoreTable();
+
+    bool			load(const JsonObject &);
+
+    int				base(void) const { return baseScore; }
+    int				limit(void) const { return limitScore; }
+
+    // first matched rule value, 0 if none
+    int				value(int section, const ScoreFeatures &) const;
+
+    // func(bonus, value) for each matched rule, one per group
+    template<typename Func>
+    void			apply(int section, const ScoreFeatures & features, Func func) const
+    {
+	uint32_t fired = 0;
+
+	for(int it = sections[section].first; it < sections[section].second; ++it)
+	{
+	    const ScoreRule & rule = rules[it];
+
+	    if(0 == (fired & rule.group) && match(rule, features))
+	    {
+		fired |= rule.group;
+		func(rule.bonus, rule.valueFeature == Score::FeatureNone ? rule.value : features[rule.valueFeature]);
+	    }
+	}
+    }
+};
+
+#endif
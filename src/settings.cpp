@@ -31,6 +31,7 @@ namespace
     bool gameAccel = true;
     bool gameFullscreen = false;
     bool guardianRulesSound = true;
+    int gameAiLevel = 1;
     std::string lang;
 }
 
@@ -46,6 +47,7 @@ bool Settings::read(void)
 	gameAccel = jo.getBoolean("display:accel", true);
 
 	guardianRulesSound = jo.getBoolean("sound:guardianrules", true);
+	gameAiLevel = jo.getInteger("ai:level", 1);
 	lang = jo.getString("language", Systems::messageLocale(1));
     }
 
@@ -82,6 +84,11 @@ bool Settings::soundGuardianRules(void)
     return guardianRulesSound;
 }
 
+int Settings::aiLevel(void)
+{
+    return gameAiLevel;
+}
+
 //////////////////////////////////////////////////////
 std::string Settings::fileSaveGame(void)
 {
@@ -26,7 +26,8 @@
 #include <string>
 
 #define FORMAT_VERSION_20200321	20200321
-#define FORMAT_VERSION_CURRENT	FORMAT_VERSION_20200321
+#define FORMAT_VERSION_20261019	20261019 /* lands owners */
+#define FORMAT_VERSION_CURRENT	FORMAT_VERSION_20261019
 #define FORMAT_VERSION_LAST	FORMAT_VERSION_20200321
 
 namespace Settings
@@ -42,6 +43,7 @@ namespace Settings
     bool		soundGuardianRules(void);
     bool		fullscreen(void);
     bool		accel(void);
+    int			aiLevel(void);
 
     bool		storeCache(void);
 }
@@ -0,0 +1,185 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#include <atomic>
+
+#include "actions.h"
+#include "threadpool.h"
+#include "simulation.h"
+
+namespace Simulation
+{
+    // protection: infinite loop
+    const size_t stepsLimit = 100000;
+
+    int		playMahjongPart(PartStats &);
+    int		playAdventurePart(PartStats &);
+}
+
+Person Simulation::initGame(unsigned int seed)
+{
+    GameData::setRandomSeed(seed);
+
+    Avatar avatar = Avatar::random();
+    const AvatarInfo & info = GameData::avatarInfo(avatar);
+    auto clan = GameData::randomIterator(info.clans.begin(), info.clans.end());
+
+    Person person(avatar, (clan != info.clans.end() ? *clan : Clan::random()), Wind());
+    GameData::initPersons(person, true);
+
+    DEBUG("seed: " << seed << ", " << "person: " << person.toString());
+    return person;
+}
+
+int Simulation::playMahjongPart(PartStats & stats)
+{
+    const Avatar & avatar = GameData::myPerson().avatar;
+    ActionList actions;
+
+    GameData::client2Mahjong(avatar, ClientReady(), actions);
+
+    while(GameData::loadedGamePart() == Menu::MahjongPart)
+    {
+	if(++stats.steps > stepsLimit)
+	{
+	    ERROR("steps limit: " << "mahjong part");
+	    return Menu::GameExit;
+	}
+
+	GameData::mahjong2Client(avatar, actions);
+
+	stats.actions += actions.size();
+	actions.clear();
+    }
+
+    return Menu::MahjongSummaryPart;
+}
+
+int Simulation::playAdventurePart(PartStats & stats)
+{
+    if(! GameData::initAdventure())
+	return Menu::GameSummaryPart;
+
+    const Avatar & avatar = GameData::myPerson().avatar;
+    ActionList actions;
+    bool adventureEnd = false;
+
+    while(! adventureEnd)
+    {
+	if(++stats.steps > stepsLimit)
+	{
+	    ERROR("steps limit: " << "adventure part");
+	    return Menu::GameExit;
+	}
+
+	GameSession & gs = GameData::session();
+	const LocalPlayer* current = gs.gamers.playerOfWind(gs.currentWind);
+	// battle step: only adventureBattleAction of the current clan, without moves planning
+	const bool battleStep = current && current->adventurePartDone() && gs.gamePart == Menu::AdventurePart;
+
+	auto tp = std::chrono::steady_clock::now();
+	GameData::adventure2Client(avatar, actions);
+	auto elapsed = std::chrono::steady_clock::now() - tp;
+	size_t battles = 0;
+
+	for(auto & action : actions)
+	{
+	    if(action.type() == Action::AdventureCombat)
+		battles++;
+	    else
+	    if(action.type() == Action::AdventureEnd)
+		adventureEnd = true;
+	}
+
+	stats.battles += battles;
+
+	if(battleStep)
+	    stats.battlesTime += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+
+	stats.actions += actions.size();
+	actions.clear();
+    }
+
+    return Menu::BattleSummaryPart;
+}
+
+int Simulation::playPart(int menu, PartStats* stats)
+{
+    PartStats local;
+    PartStats & res = stats ? *stats : local;
+
+    switch(menu)
+    {
+	case Menu::MahjongInitPart:
+	    return GameData::initMahjong() ? Menu::MahjongPart : Menu::GameSummaryPart;
+
+	case Menu::MahjongPart:
+	    return playMahjongPart(res);
+
+	case Menu::MahjongSummaryPart:
+	    return Menu::AdventurePart;
+
+	case Menu::AdventurePart:
+	    return playAdventurePart(res);
+
+	case Menu::BattleSummaryPart:
+	    return GameData::isGameOver() ? Menu::GameSummaryPart : Menu::MahjongInitPart;
+
+	default: break;
+    }
+
+    return Menu::GameExit;
+}
+
+bool Simulation::playGame(unsigned int seed)
+{
+    initGame(seed);
+    int menu = Menu::MahjongInitPart;
+
+    while(menu != Menu::GameExit)
+    {
+	if(menu == Menu::GameSummaryPart)
+	    return true;
+
+	menu = playPart(menu);
+    }
+
+    return false;
+}
+
+size_t Simulation::playGames(const std::vector<unsigned int> & seeds, size_t threads)
+{
+    std::atomic<size_t> finished(0);
+    ThreadPool pool(threads);
+
+    for(auto & seed : seeds)
+    {
+	pool.push([seed, &finished]()
+	{
+	    SessionScope scope;
+	    if(playGame(seed)) finished++;
+	});
+    }
+
+    pool.wait();
+    return finished;
+}
@@ -0,0 +1,64 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef _RWNA_SIMULATION_
+#define _RWNA_SIMULATION_
+
+#include <chrono>
+
+#include "gamedata.h"
+
+/* headless game: all players AI, without display and screens */
+namespace Simulation
+{
+    struct PartStats
+    {
+	size_t			steps;
+	size_t			actions;
+	size_t			battles;
+	std::chrono::nanoseconds battlesTime;
+
+	PartStats() : steps(0), actions(0), battles(0), battlesTime(0) {}
+    };
+
+    /* own game session for the current thread */
+    class SessionScope
+    {
+	GameSession		session;
+
+    public:
+	SessionScope() { GameData::setSession(& session); }
+	~SessionScope() { GameData::setSession(nullptr); }
+
+	SessionScope(const SessionScope &) = delete;
+	SessionScope & operator=(const SessionScope &) = delete;
+    };
+
+    Person			initGame(unsigned int seed);
+    int				playPart(int menu, PartStats* = nullptr);
+    bool			playGame(unsigned int seed);
+
+    /* independent games on thread pool, 0: thread per core; return: finished games */
+    size_t			playGames(const std::vector<unsigned int> & seeds, size_t threads = 0);
+}
+
+#endif
@@ -0,0 +1,95 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include <algorithm>
+
+#include "threadpool.h"
+
+ThreadPool::ThreadPool(size_t threads) : active(0), shutdown(false)
+{
+    if(0 == threads)
+	threads = std::max(1U, std::thread::hardware_concurrency());
+
+    workers.reserve(threads);
+
+    for(size_t it = 0; it < threads; ++it)
+	workers.emplace_back(& ThreadPool::workerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+	std::lock_guard<std::mutex> guard(lock);
+	shutdown = true;
+    }
+
+    taskReady.notify_all();
+
+    for(auto & worker : workers)
+	worker.join();
+}
+
+void ThreadPool::push(std::function<void(void)> task)
+{
+    {
+	std::lock_guard<std::mutex> guard(lock);
+	tasks.push(std::move(task));
+    }
+
+    taskReady.notify_one();
+}
+
+void ThreadPool::wait(void)
+{
+    std::unique_lock<std::mutex> guard(lock);
+    tasksDone.wait(guard, [this]{ return tasks.empty() && 0 == active; });
+}
+
+void ThreadPool::workerLoop(void)
+{
+    while(true)
+    {
+	std::function<void(void)> task;
+
+	{
+	    std::unique_lock<std::mutex> guard(lock);
+	    taskReady.wait(guard, [this]{ return shutdown || ! tasks.empty(); });
+
+	    if(tasks.empty())
+		return;
+
+	    task = std::move(tasks.front());
+	    tasks.pop();
+	    active++;
+	}
+
+	task();
+
+	{
+	    std::lock_guard<std::mutex> guard(lock);
+	    active--;
+	}
+
+	tasksDone.notify_all();
+    }
+}
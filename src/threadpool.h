@@ -0,0 +1,56 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#ifndef _RWNA_THREADPOOL_
+#define _RWNA_THREADPOOL_
+
+#include <queue>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+/* fixed workers, fifo tasks */
+class ThreadPool
+{
+    std::vector<std::thread>	workers;
+    std::queue<std::function<void(void)>> tasks;
+    std::mutex			lock;
+    std::condition_variable	taskReady;
+    std::condition_variable	tasksDone;
+    size_t			active;
+    bool			shutdown;
+
+    void			workerLoop(void);
+
+public:
+    ThreadPool(size_t threads = 0); // 0: thread per core
+    ~ThreadPool();
+
+    void			push(std::function<void(void)>);
+    void			wait(void);
+    size_t			size(void) const { return workers.size(); }
+};
+
+#endif
@@ -0,0 +1,78 @@
+/***************************************************************************
+ *   Copyright (C) 2020 by RuneWarsNA team <runewars.newage@gmail.com>     *
+ *                                                                         *
+ *   Part of the RuneWars: NewAge engine:                                  *
+ *   https://github.com/AndreyBarmaley/runewars.newage                     *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+
+#include <vector>
+#include <fstream>
+
+#include "runewars.h"
+#include "gametheme.h"
+#include "gamedata.h"
+#include "landmap.h"
+
+/* offline map compiler: validate lands.json of the theme and write lands.map */
+int main(int argc, char **argv)
+{
+    Systems::setLocale(LC_ALL, "");
+    Systems::setLocale(LC_NUMERIC, "C");
+
+    Application app(argv[0], false, Size(0, 0), "default");
+    LogWrapper::init(Application::domain(), argv[0]);
+
+    if(2 > argc)
+    {
+	COUT("Usage: " << argv[0] << " <lands.map> [theme]");
+	return EXIT_FAILURE;
+    }
+
+    if(2 < argc)
+	app.theme = argv[2];
+
+    try
+    {
+	// lands.json checked by game data init, compiled assets not used: invalid map fails here
+	if(! GameTheme::initHeadless(app, false))
+	    return EXIT_FAILURE;
+
+	std::vector<uint8_t> blob;
+
+	if(! GameData::compileLandMap(blob))
+	    return EXIT_FAILURE;
+
+	std::ofstream ofs(argv[1], std::ios::binary | std::ios::trunc);
+	ofs.write(reinterpret_cast<const char*>(blob.data()), blob.size());
+
+	if(! ofs)
+	{
+	    ERROR("write error: " << argv[1]);
+	    return EXIT_FAILURE;
+	}
+
+	VERBOSE("lands map: " << argv[1] << ", " << "size: " << blob.size());
+	return EXIT_SUCCESS;
+    }
+    catch(Engine::exception &)
+    {
+    }
+
+    return EXIT_FAILURE;
+}